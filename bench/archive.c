@@ -0,0 +1,135 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "core/archive.h"
+#include "core/replay.h"
+
+#define APPEND_COUNT 50000
+#define PLAYER_COUNT 1000
+#define REPLAY_FRAMES 5000
+
+typedef struct {
+  const char *path;
+  const void *replay;
+  uint32_t length;
+  long checked;
+  bool isWrong;
+} ArchiveReader;
+
+static double NowSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// A second open of the archive checking every entry as it shows up, the way another process would while the writer appends
+static void *ReadWhileAppending(void *arg) {
+  ArchiveReader *reader = arg;
+  Archive *archive = ArchiveOpen(reader->path, false);
+  void *replay = malloc(reader->length);
+  if (!archive || !replay) {
+    reader->isWrong = true;
+    return NULL;
+  }
+  const ArchiveEntry *entries = ArchiveGetEntries(archive);
+  uint32_t seen = 0;
+  while (seen < APPEND_COUNT && !reader->isWrong) {
+    const uint32_t count = ArchiveGetCount(archive);
+    for (; seen < count; seen++) {
+      const ArchiveEntry *entry = &entries[seen];
+      reader->isWrong |= entry->player != seen % PLAYER_COUNT || entry->length != reader->length;
+      if (seen % 64 == 0) {
+        reader->isWrong |= !ArchiveRead(archive, entry, replay) || memcmp(replay, reader->replay, reader->length) != 0;
+      }
+      reader->checked++;
+    }
+  }
+  free(replay);
+  ArchiveClose(archive);
+  return NULL;
+}
+
+int main(void) {
+  // one replay of random play, appended under many players
+  static SimState state;
+  SimReset(&state, 5);
+  SimStart(&state, 18);
+  FILE *file = tmpfile();
+  ReplayWriter *writer = file ? ReplayWriterCreate(file, 5, &state, REPLAY_KEYFRAME_INTERVAL) : NULL;
+  if (!writer) {
+    fprintf(stderr, "couldn't create a replay\n");
+    return 1;
+  }
+  Rng rng;
+  RngSeed(&rng, 5);
+  uint8_t input = 0;
+  for (int frame = 0; frame < REPLAY_FRAMES; frame++) {
+    input = RngRange(&rng, 0, 3) == 0 ? RngRange(&rng, 0, 31) : input;
+    SimStep(&state, input);
+    ReplayWriterAdd(writer, input, &state);
+  }
+  ReplayWriterFinish(writer, &state);
+  const uint32_t length = ftell(file);
+  void *replay = malloc(length);
+  rewind(file);
+  if (!replay || fread(replay, length, 1, file) != 1) {
+    fprintf(stderr, "couldn't read the replay back\n");
+    return 1;
+  }
+  fclose(file);
+
+  char path[64];
+  snprintf(path, sizeof(path), "/tmp/bench_archive_%d", (int)getpid());
+  Archive *archive = ArchiveCreate(path, APPEND_COUNT);
+  if (!archive) {
+    fprintf(stderr, "couldn't create %s\n", path);
+    return 1;
+  }
+  ArchiveReader reader = {.path = path, .replay = replay, .length = length};
+  pthread_t thread;
+  const bool hasReader = pthread_create(&thread, NULL, ReadWhileAppending, &reader) == 0;
+  const double start = NowSeconds();
+  for (int i = 0; i < APPEND_COUNT; i++) {
+    if (!ArchiveAppend(archive, i % PLAYER_COUNT, replay, length)) {
+      fprintf(stderr, "couldn't append entry %d\n", i);
+      return 1;
+    }
+  }
+  const double appendSeconds = NowSeconds() - start;
+  if (hasReader) {
+    pthread_join(thread, NULL);
+  }
+  if (reader.isWrong || ArchiveAppend(archive, 0, replay, length)) {
+    fprintf(stderr, "the archive read back wrong, or took more entries than it has room for\n");
+    return 1;
+  }
+  printf("Archive: %d appends of %u byte replays, %.0f appends/s, %ld entries checked by a concurrent reader\n", APPEND_COUNT, length,
+         APPEND_COUNT / appendSeconds, reader.checked);
+  ArchiveClose(archive);
+
+  // a leaderboard query straight off the mapped index
+  archive = ArchiveOpen(path, false);
+  const ArchiveEntry *entries = ArchiveGetEntries(archive);
+  const double scanStart = NowSeconds();
+  int best = -1;
+  for (int round = 0; round < 10; round++) {
+    const uint32_t count = ArchiveGetCount(archive);
+    best = -1;
+    for (uint32_t i = 0; i < count; i++) {
+      if (entries[i].player == 42 && (best < 0 || entries[i].score > entries[best].score)) {
+        best = i;
+      }
+    }
+  }
+  const double scanSeconds = (NowSeconds() - scanStart) / 10;
+  printf("Archive: best score of a player over %d entries in %.2f ms, %.2f ns/entry\n", APPEND_COUNT, scanSeconds * 1e3,
+         scanSeconds * 1e9 / APPEND_COUNT);
+  ArchiveClose(archive);
+  unlink(path);
+  free(replay);
+  return best < 0;
+}
@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bot/bot.h"
+
+#define POSITION_COUNT 256
+#define DECISION_ROUNDS 8
+#define GAME_PIECE_LIMIT 2000
+#define AHEAD_PIECE_LIMIT 100
+
+static double NowSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Lets a single threaded bot play, keeping the state at every new piece as positions for the timing runs
+static int PlayGame(SimState *positions, int level, size_t transpositionBytes, int *linesCleared, BotStats *stats) {
+  static SimState state;
+  BotConfig config = botDefaultConfig;
+  config.threadCount = 1;
+  config.transpositionBytes = transpositionBytes;
+  Bot *bot = BotCreate(&config);
+  SimReset(&state, 7);
+  SimStart(&state, level);
+  int count = 0;
+  int pieces = 0;
+  int previousPieces = -1;
+  while (!state.isGameOver && pieces < GAME_PIECE_LIMIT) {
+    pieces = 0;
+    for (int i = 0; i < PIECE_COUNT; i++) {
+      pieces += state.statistics[i];
+    }
+    if (pieces != previousPieces && count < POSITION_COUNT) {
+      positions[count++] = state;
+    }
+    previousPieces = pieces;
+    SimStep(&state, BotGetInput(bot, &state));
+  }
+  *linesCleared = state.linesCleared;
+  *stats = bot->stats;
+  BotDestroy(bot);
+  return count;
+}
+
+// Plans every piece during the previous one's entry delay, with a fraction of it as the budget, the way the agent thinks ahead
+static void PlayAheadGame(double budgetScale, int *linesCleared, int *pieces, BotStats *stats) {
+  static SimState state;
+  BotConfig config = botDefaultConfig;
+  config.transpositionBytes = 0;
+  Bot *bot = BotCreate(&config);
+  BotController controller = {0};
+  SimReset(&state, 11);
+  SimStart(&state, 29);
+  bool hasPlan = false;
+  Placement plan;
+  int previousPieces = 0;
+  while (!state.isGameOver && BotGetPieceCount(&state) < AHEAD_PIECE_LIMIT) {
+    const int pieceCount = BotGetPieceCount(&state);
+    if (pieceCount != previousPieces) {
+      Placement target;
+      const bool hasTarget = hasPlan || BotDecide(bot, &state, &target);
+      BotControllerSetTarget(&controller, hasTarget ? (hasPlan ? &plan : &target) : NULL);
+      hasPlan = false;
+      previousPieces = pieceCount;
+    }
+    if (state.ARETimer == 1 && state.animationTimer == 0) {
+      const double deadline = NowSeconds() + SimGetFramesUntilSpawn(&state) / SIM_FRAME_RATE * budgetScale;
+      hasPlan = BotDecideAhead(bot, &state, deadline, &plan);
+    }
+    SimStep(&state, BotControllerGetInput(&controller, &state));
+  }
+  *linesCleared = state.linesCleared;
+  *pieces = BotGetPieceCount(&state);
+  *stats = bot->stats;
+  BotDestroy(bot);
+}
+
+int main(void) {
+  static SimState positions[POSITION_COUNT];
+  int linesCleared = 0;
+  BotStats stats;
+  double gameStart = NowSeconds();
+  const int positionCount = PlayGame(positions, 9, 0, &linesCleared, &stats);
+  printf("Bot: level 9 game, %d lines in %.2f s\n", linesCleared, NowSeconds() - gameStart);
+
+  // hits hand back exactly what the search would have found, so the game must play out the same
+  int cachedLinesCleared = 0;
+  gameStart = NowSeconds();
+  PlayGame(positions, 9, botDefaultConfig.transpositionBytes, &cachedLinesCleared, &stats);
+  printf("Bot: level 9 game with a %zu MiB transposition table, %d lines in %.2f s, %.1f%% of %ld probes hit\n",
+         botDefaultConfig.transpositionBytes >> 20, cachedLinesCleared, NowSeconds() - gameStart,
+         100.0 * stats.transpositionHits / stats.transpositionProbes, stats.transpositionProbes);
+  if (cachedLinesCleared != linesCleared) {
+    fprintf(stderr, "the transposition table changed the game\n");
+    return 1;
+  }
+
+  const int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  double baseline = 0.0;
+  for (int threads = 1; threads <= 32 && threads <= cores; threads *= 2) {
+    BotConfig config = botDefaultConfig;
+    config.threadCount = threads;
+    config.maxBeamWidth = BOT_MAX_BEAM_WIDTH;
+    // the same positions come back every round, a table would turn the later rounds into lookups
+    config.transpositionBytes = 0;
+    Bot *bot = BotCreate(&config);
+    Placement placement;
+    const double start = NowSeconds();
+    for (int round = 0; round < DECISION_ROUNDS; round++) {
+      for (int i = 0; i < positionCount; i++) {
+        BotDecide(bot, &positions[i], &placement);
+      }
+    }
+    const double decisionsPerSecond = bot->stats.decisions / (NowSeconds() - start);
+    baseline = threads == 1 ? decisionsPerSecond : baseline;
+    printf("BotDecide: %2d threads (%d cores), beam %d, %.0f decisions/s, %.2fx\n", PoolThreadCount(bot->pool), cores, bot->beamWidth,
+           decisionsPerSecond, decisionsPerSecond / baseline);
+    BotDestroy(bot);
+  }
+
+  // expectimax against the plain two piece search on the same positions, on one thread so the nodes/s compare per core
+  static const char *searchNames[] = {"beam", "expectimax"};
+  for (int search = BOT_SEARCH_BEAM; search <= BOT_SEARCH_EXPECTIMAX; search++) {
+    BotConfig config = botDefaultConfig;
+    config.threadCount = 1;
+    config.search = search;
+    config.transpositionBytes = 0;
+    Bot *bot = BotCreate(&config);
+    Placement placement;
+    const double start = NowSeconds();
+    for (int i = 0; i < positionCount; i++) {
+      BotDecide(bot, &positions[i], &placement);
+    }
+    const double seconds = NowSeconds() - start;
+    const BotStats *searchStats = &bot->stats;
+    printf("BotDecide %-10s: beam %d, %.0f decisions/s, %.2fM nodes/s, %.0f nodes/decision, %.1f%% of third piece branches pruned\n",
+           searchNames[search], bot->beamWidth, searchStats->decisions / seconds, searchStats->nodes / seconds / 1e6,
+           (double)searchStats->nodes / searchStats->decisions,
+           searchStats->chanceNodes > 0 ? 100.0 * searchStats->prunedBranches / (searchStats->chanceNodes * PIECE_COUNT) : 0.0);
+    BotDestroy(bot);
+  }
+
+  // more of the entry delay lets the search go deeper, and deeper plays better
+  static const double budgetScales[] = {1.0 / 64, 1.0 / 16, 1.0 / 4};
+  for (int i = 0; i < 3; i++) {
+    int aheadLinesCleared = 0;
+    int pieces = 0;
+    BotStats aheadStats;
+    PlayAheadGame(budgetScales[i], &aheadLinesCleared, &pieces, &aheadStats);
+    double depthSum = 0.0;
+    for (int depth = 1; depth <= BOT_MAX_DEPTH; depth++) {
+      depthSum += (double)depth * aheadStats.depthCounts[depth];
+    }
+    printf("BotDecideAhead: 1/%-2.0f of the entry delay, level 29 game, %d lines in %d pieces, depth %.2f, %.0f nodes/move\n",
+           1.0 / budgetScales[i], aheadLinesCleared, pieces, depthSum / aheadStats.decisions,
+           (double)aheadStats.nodes / aheadStats.decisions);
+  }
+  return 0;
+}
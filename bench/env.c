@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "core/env.h"
+
+#define GAME_COUNT 1024
+#define STEPS 2000
+
+static double NowSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Mostly holds down with the odd move or rotation, so games both stack and top out
+static void RandomActions(Rng *rng, uint8_t *actions) {
+  for (int i = 0; i < GAME_COUNT; i++) {
+    const uint32_t roll = RngNext(rng);
+    actions[i] = (roll & 1 ? INPUT_DOWN : 0) | (roll >> 1 & 3 ? 0 : (roll >> 3) % (INPUT_ROTATE_COUNTER_CLOCKWISE << 1));
+  }
+}
+
+static double RunSteps(Env *env, EnvObservation *observation, uint8_t *actions, float *rewards, uint8_t *dones, long *episodes) {
+  Rng rng;
+  RngSeed(&rng, 3);
+  EnvReset(env, observation);
+  double seconds = 0.0;
+  *episodes = 0;
+  for (int step = 0; step < STEPS; step++) {
+    RandomActions(&rng, actions);
+    const double begin = NowSeconds();
+    EnvStep(env, actions, observation, rewards, dones);
+    seconds += NowSeconds() - begin;
+    for (int i = 0; i < GAME_COUNT; i++) {
+      *episodes += dones[i];
+    }
+  }
+  return seconds;
+}
+
+int main(void) {
+  static uint16_t rows[ROWS * GAME_COUNT];
+  static uint8_t currentType[GAME_COUNT], currentRotation[GAME_COUNT], nextType[GAME_COUNT], level[GAME_COUNT];
+  static int8_t currentX[GAME_COUNT], currentY[GAME_COUNT];
+  static int32_t linesCleared[GAME_COUNT], score[GAME_COUNT];
+  static uint8_t actions[GAME_COUNT], dones[GAME_COUNT];
+  static float rewards[GAME_COUNT];
+  EnvObservation full = {rows, currentType, currentX, currentY, currentRotation, nextType, level, linesCleared, score};
+  EnvObservation none = {0};
+
+  if (EnvCreate(GAME_COUNT, -1, 7) || EnvCreate(GAME_COUNT, SIM_MAX_STARTING_LEVEL + 1, 7)) {
+    fprintf(stderr, "games were created at a level the game can't start on\n");
+    return 1;
+  }
+  Env *env = EnvCreate(GAME_COUNT, 18, 7);
+  if (!env) {
+    fprintf(stderr, "could not create %d games\n", GAME_COUNT);
+    return 1;
+  }
+
+  // every game must follow SimStep exactly, including across auto resets
+  const int last = GAME_COUNT - 1;
+  SimState reference;
+  SimReset(&reference, RngStreamSeed(7, (uint64_t)last << 32));
+  SimStart(&reference, 18);
+  Rng rng;
+  RngSeed(&rng, 3);
+  EnvReset(env, &full);
+  int32_t rewardTotal = 0;
+  for (int step = 0; step < STEPS && !reference.isGameOver; step++) {
+    RandomActions(&rng, actions);
+    EnvStep(env, actions, &full, rewards, dones);
+    SimStep(&reference, actions[last]);
+    rewardTotal += (int32_t)rewards[last];
+    const bool isSame = score[last] == reference.score && currentX[last] == reference.currentPiece.x &&
+                        currentY[last] == reference.currentPiece.y &&
+                        rows[(ROWS - 1) * GAME_COUNT + last] == reference.board.rows[ROWS - 1];
+    if (reference.isGameOver ? !dones[last] : dones[last] || !isSame) {
+      fprintf(stderr, "game %d differs from SimStep at step %d\n", last, step);
+      return 1;
+    }
+  }
+  if (rewardTotal != reference.score) {
+    fprintf(stderr, "rewards add up to %d, SimStep scored %d\n", rewardTotal, reference.score);
+    return 1;
+  }
+
+  long episodes;
+  const double fullSeconds = RunSteps(env, &full, actions, rewards, dones, &episodes);
+  printf("EnvStep: %d games x %d steps, %ld episodes, %.1fM steps/s with full observations\n", GAME_COUNT, STEPS, episodes,
+         (double)GAME_COUNT * STEPS / fullSeconds / 1e6);
+  const double noneSeconds = RunSteps(env, &none, actions, rewards, dones, &episodes);
+  printf("EnvStep: %d games x %d steps, %ld episodes, %.1fM steps/s without observations\n", GAME_COUNT, STEPS, episodes,
+         (double)GAME_COUNT * STEPS / noneSeconds / 1e6);
+  EnvDestroy(env);
+  return 0;
+}
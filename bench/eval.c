@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bot/eval.h"
+
+#define BATCH_COUNT 64
+#define ITERATIONS 4000
+
+static double NowSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Midgame-looking boards: a random skyline with most cells below it filled
+static void RandomBoard(Board *board) {
+  BoardReset(board);
+  for (int x = 0; x < COLUMNS; x++) {
+    const int height = rand() % (PLAYFIELD_ROWS / 2);
+    for (int y = ROWS - height; y < ROWS; y++) {
+      if (rand() % 8 != 0) {
+        board->rows[y] |= BOARD_CELL(x);
+      }
+    }
+  }
+}
+
+int main(void) {
+  static Board boards[BATCH_COUNT][EVAL_BATCH_SIZE];
+  static EvalBatch batches[BATCH_COUNT];
+  static float scores[EVAL_BATCH_SIZE];
+  static const char *pathNames[] = {"scalar", "SSE2", "AVX2"};
+  srand(1);
+  for (int b = 0; b < BATCH_COUNT; b++) {
+    batches[b].count = EVAL_BATCH_SIZE;
+    for (int i = 0; i < EVAL_BATCH_SIZE; i++) {
+      RandomBoard(&boards[b][i]);
+      EvalBatchSetBoard(&batches[b], i, &boards[b][i], rand() % 5);
+    }
+  }
+
+  // every batched path has to agree with EvalGetFeatures before it gets timed
+  const EvalPath bestPath = EvalGetBestPath();
+  for (int path = EVAL_PATH_SCALAR; path <= (int)bestPath; path++) {
+    for (int b = 0; b < BATCH_COUNT; b++) {
+      EvalFeatures features[EVAL_BATCH_SIZE];
+      EvalBatchGetFeatures(&batches[b], path, features);
+      for (int i = 0; i < EVAL_BATCH_SIZE; i++) {
+        EvalFeatures expected;
+        EvalGetFeatures(&boards[b][i], &expected);
+        if (memcmp(&expected, &features[i], sizeof(EvalFeatures)) != 0) {
+          fprintf(stderr, "%s path: features of board %d differ\n", pathNames[path], b * EVAL_BATCH_SIZE + i);
+          return 1;
+        }
+      }
+    }
+  }
+
+  const double boardCount = (double)ITERATIONS * BATCH_COUNT * EVAL_BATCH_SIZE;
+  float sum = 0.0f;
+  double start = NowSeconds();
+  for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+    for (int b = 0; b < BATCH_COUNT; b++) {
+      for (int i = 0; i < EVAL_BATCH_SIZE; i++) {
+        sum += EvalBoard(&boards[b][i], batches[b].linesCleared[i], &evalDefaultWeights);
+      }
+    }
+  }
+  double elapsed = NowSeconds() - start;
+  const double baseline = boardCount / elapsed;
+  printf("EvalBoard: %.1f M boards/s\n", baseline / 1e6);
+
+  for (int path = EVAL_PATH_SCALAR; path <= (int)bestPath; path++) {
+    start = NowSeconds();
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+      for (int b = 0; b < BATCH_COUNT; b++) {
+        EvalBatchScore(&batches[b], &evalDefaultWeights, path, scores);
+        sum += scores[iteration % EVAL_BATCH_SIZE];
+      }
+    }
+    elapsed = NowSeconds() - start;
+    printf("EvalBatchScore (%s): %.1f M boards/s, %.2fx\n", pathNames[path], boardCount / elapsed / 1e6, boardCount / elapsed / baseline);
+  }
+  // keep the scores alive so none of the loops get optimized away
+  __asm__ volatile("" : : "g"(sum));
+  return 0;
+}
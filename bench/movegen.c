@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "core/movegen.h"
+#include "core/zobrist.h"
+
+#define BOARD_COUNT 256
+#define ITERATIONS 20000
+
+static double NowSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Midgame-looking boards: a random skyline with most cells below it filled
+static void RandomBoard(Board *board) {
+  BoardReset(board);
+  for (int x = 0; x < COLUMNS; x++) {
+    const int height = rand() % (PLAYFIELD_ROWS / 2);
+    for (int y = ROWS - height; y < ROWS; y++) {
+      if (rand() % 8 != 0) {
+        board->rows[y] |= BOARD_CELL(x);
+      }
+    }
+  }
+}
+
+// the cells a placement fills, as a key that is equal for placements leaving the same board
+static uint64_t PlacementKey(int type, int rotationIndex, int x, int y) {
+  const PieceConfiguration *rotation = &tetrominoes[type].rotations[rotationIndex];
+  uint64_t key = 0;
+  for (int i = 0; i < 4; i++) {
+    key ^= ZobristCell(x + rotation->cells[i].x, y + rotation->cells[i].y);
+  }
+  return key;
+}
+
+static int CompareKeys(const void *a, const void *b) {
+  const uint64_t left = *(const uint64_t *)a;
+  const uint64_t right = *(const uint64_t *)b;
+  return (left > right) - (left < right);
+}
+
+// Plain breadth-first search over single moves with PieceFits, returns the sorted distinct lock keys
+static int ReferencePlacements(const Board *board, const Piece *piece, uint64_t *keys) {
+  static bool visited[4][16][ROWS];
+  static Piece queue[4 * 16 * ROWS];
+  memset(visited, 0, sizeof(visited));
+  int head = 0;
+  int tail = 0;
+  int count = 0;
+  queue[tail++] = *piece;
+  visited[piece->rotationIndex][piece->x + 3][piece->y] = true;
+  while (head < tail) {
+    const Piece current = queue[head++];
+    const Piece moves[5] = {
+        {current.type, current.x - 1, current.y, current.rotationIndex},
+        {current.type, current.x + 1, current.y, current.rotationIndex},
+        {current.type, current.x, current.y, (current.rotationIndex + 1) & 3},
+        {current.type, current.x, current.y, (current.rotationIndex + 3) & 3},
+        {current.type, current.x, current.y + 1, current.rotationIndex},
+    };
+    for (int i = 0; i < 5; i++) {
+      const Piece *next = &moves[i];
+      if (!PieceFits(board, next->type, next->rotationIndex, next->x, next->y)) {
+        if (i == 4) {
+          keys[count++] = PlacementKey(current.type, current.rotationIndex, current.x, current.y);
+        }
+        continue;
+      }
+      if (!visited[next->rotationIndex][next->x + 3][next->y]) {
+        visited[next->rotationIndex][next->x + 3][next->y] = true;
+        queue[tail++] = *next;
+      }
+    }
+  }
+  qsort(keys, count, sizeof(uint64_t), CompareKeys);
+  int distinct = 0;
+  for (int i = 0; i < count; i++) {
+    if (distinct == 0 || keys[distinct - 1] != keys[i]) {
+      keys[distinct++] = keys[i];
+    }
+  }
+  return distinct;
+}
+
+int main(void) {
+  static Board boards[BOARD_COUNT];
+  static PlacementList list;
+  static uint64_t expected[MOVEGEN_MAX_PLACEMENTS];
+  static uint64_t actual[MOVEGEN_MAX_PLACEMENTS];
+  srand(1);
+  for (int i = 0; i < BOARD_COUNT; i++) {
+    RandomBoard(&boards[i]);
+  }
+
+  // check against the reference search before timing anything
+  for (int i = 0; i < BOARD_COUNT; i++) {
+    for (int type = 0; type < PIECE_COUNT; type++) {
+      const Piece piece = {type, INITIAL_BOARD_X, INITIAL_BOARD_Y, INITIAL_ROTATION};
+      if (!PieceFits(&boards[i], type, piece.rotationIndex, piece.x, piece.y)) {
+        continue;
+      }
+      MovegenPlacements(&boards[i], &piece, &list);
+      for (int p = 0; p < list.count; p++) {
+        const Placement *placement = &list.placements[p];
+        actual[p] = PlacementKey(type, placement->rotationIndex, placement->x, placement->y);
+      }
+      qsort(actual, list.count, sizeof(uint64_t), CompareKeys);
+      const int expectedCount = ReferencePlacements(&boards[i], &piece, expected);
+      if (expectedCount != list.count || memcmp(expected, actual, list.count * sizeof(uint64_t)) != 0) {
+        fprintf(stderr, "board %d piece %d: %d placements, expected %d\n", i, type, list.count, expectedCount);
+        return 1;
+      }
+    }
+  }
+
+  long placements = 0;
+  long calls = 0;
+  const double start = NowSeconds();
+  for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+    const Board *board = &boards[iteration % BOARD_COUNT];
+    for (int type = 0; type < PIECE_COUNT; type++) {
+      const Piece piece = {type, INITIAL_BOARD_X, INITIAL_BOARD_Y, INITIAL_ROTATION};
+      MovegenPlacements(board, &piece, &list);
+      placements += list.count;
+      calls++;
+    }
+  }
+  const double elapsed = NowSeconds() - start;
+
+  printf("MovegenPlacements: %ld calls, %.1f placements/call, %.1f ns/call, %.1f ns/placement\n", calls, (double)placements / calls,
+         elapsed * 1e9 / calls, elapsed * 1e9 / placements);
+  return 0;
+}
@@ -0,0 +1,68 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "core/tetromino.h"
+
+#define BOARD_COUNT 64
+#define QUERY_COUNT 4096
+#define ITERATIONS 2000
+
+typedef struct {
+  int8_t type;
+  int8_t rotationIndex;
+  int8_t x;
+  int8_t y;
+} Query;
+
+static double NowSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Midgame-looking boards: a random skyline with most cells below it filled
+static void RandomBoard(Board *board) {
+  for (int row = 0; row < ROWS; row++) {
+    board->rows[row] = BOARD_EMPTY_ROW;
+  }
+  for (int row = ROWS; row < ROWS + BOARD_FLOOR_ROWS; row++) {
+    board->rows[row] = BOARD_FULL_ROW;
+  }
+  for (int x = 0; x < COLUMNS; x++) {
+    const int height = rand() % (PLAYFIELD_ROWS / 2);
+    for (int y = ROWS - height; y < ROWS; y++) {
+      if (rand() % 8 != 0) {
+        board->rows[y] |= BOARD_CELL(x);
+      }
+    }
+  }
+}
+
+int main(void) {
+  static Board boards[BOARD_COUNT];
+  static Query queries[QUERY_COUNT];
+  srand(1);
+  for (int i = 0; i < BOARD_COUNT; i++) {
+    RandomBoard(&boards[i]);
+  }
+  for (int i = 0; i < QUERY_COUNT; i++) {
+    queries[i] = (Query){rand() % PIECE_COUNT, rand() % 4, rand() % (COLUMNS + 2) - 2, rand() % ROWS};
+  }
+
+  long fitting = 0;
+  const double start = NowSeconds();
+  for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+    const Board *board = &boards[iteration % BOARD_COUNT];
+    for (int i = 0; i < QUERY_COUNT; i++) {
+      const Query *query = &queries[i];
+      fitting += PieceFits(board, query->type, query->rotationIndex, query->x, query->y);
+    }
+  }
+  const double elapsed = NowSeconds() - start;
+
+  const double calls = (double)ITERATIONS * QUERY_COUNT;
+  printf("PieceFits: %.0f calls, %.2f ns/call, %.1f%% fit\n", calls, elapsed * 1e9 / calls, 100.0 * fitting / calls);
+  return 0;
+}
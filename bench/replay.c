@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <time.h>
+
+#include "bot/bot.h"
+#include "core/replay.h"
+
+#define GAME_COUNT 4
+#define RANDOM_FRAMES 1000000
+#define SEEK_COUNT 1000
+// ten minutes
+#define FRAME_LIMIT 36060
+
+static double NowSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Records bot games the way the game records players, then streams each replay back and checks it plays out the same
+int main(void) {
+  BotConfig config = botDefaultConfig;
+  config.threadCount = 1;
+  Bot *bot = BotCreate(&config);
+  long totalBytes = 0;
+  long totalFrames = 0;
+  for (int game = 0; game < GAME_COUNT; game++) {
+    static SimState state;
+    const uint64_t seed = 100 + game;
+    SimReset(&state, seed);
+    SimStart(&state, 18);
+    bot->pieceCount = 0;
+    FILE *file = tmpfile();
+    ReplayWriter *writer = file ? ReplayWriterCreate(file, seed, &state, REPLAY_KEYFRAME_INTERVAL) : NULL;
+    if (!writer) {
+      fprintf(stderr, "couldn't create a replay\n");
+      return 1;
+    }
+    for (int frame = 0; frame < FRAME_LIMIT && !state.isGameOver; frame++) {
+      const uint8_t input = BotGetInput(bot, &state);
+      SimStep(&state, input);
+      ReplayWriterAdd(writer, input, &state);
+    }
+    if (!ReplayWriterFinish(writer, &state)) {
+      fprintf(stderr, "couldn't write the replay\n");
+      return 1;
+    }
+    const long bytes = ftell(file);
+
+    rewind(file);
+    const double start = NowSeconds();
+    ReplayReader *reader = ReplayReaderCreate(file);
+    if (!reader) {
+      fprintf(stderr, "couldn't read the replay back\n");
+      return 1;
+    }
+    const ReplayHeader *header = ReplayReaderGetHeader(reader);
+    static SimState replayed;
+    // the state after every frame, for checking seeks
+    static uint64_t hashes[FRAME_LIMIT + 1];
+    static int scores[FRAME_LIMIT + 1];
+    ReplayStart(header, &replayed);
+    uint8_t input;
+    hashes[0] = replayed.hash;
+    scores[0] = replayed.score;
+    while (ReplayReaderNext(reader, &input)) {
+      SimStep(&replayed, input);
+      hashes[ReplayReaderGetFrame(reader)] = replayed.hash;
+      scores[ReplayReaderGetFrame(reader)] = replayed.score;
+    }
+    const double seconds = NowSeconds() - start;
+    if (ReplayReaderGetFrame(reader) != header->frameCount || replayed.score != header->score ||
+        (uint32_t)replayed.linesCleared != header->linesCleared || replayed.hash != state.hash) {
+      fprintf(stderr, "replay of game %d played out differently\n", game);
+      return 1;
+    }
+
+    Rng rng;
+    RngSeed(&rng, game);
+    const double seekStart = NowSeconds();
+    for (int i = 0; i < SEEK_COUNT; i++) {
+      const uint32_t frame = RngRange(&rng, 0, header->frameCount);
+      if (!ReplayReaderSeek(reader, frame, &replayed) || replayed.hash != hashes[frame] || replayed.score != scores[frame]) {
+        fprintf(stderr, "seeking game %d to frame %u gave a different state\n", game, frame);
+        return 1;
+      }
+    }
+    const double seekSeconds = (NowSeconds() - seekStart) / SEEK_COUNT;
+    // scrubbing backwards, the way the viewer does, then playing on across the next keyframe
+    for (long frame = header->frameCount; frame >= 0; frame -= header->keyframeInterval / 2) {
+      bool isSame = ReplayReaderSeek(reader, frame, &replayed);
+      for (uint32_t i = 0; isSame && i < header->keyframeInterval && ReplayReaderNext(reader, &input); i++) {
+        SimStep(&replayed, input);
+        isSame = replayed.hash == hashes[ReplayReaderGetFrame(reader)];
+      }
+      if (!isSame) {
+        fprintf(stderr, "playing game %d on from a seek back to frame %ld went wrong at frame %u\n", game, frame,
+                ReplayReaderGetFrame(reader));
+        return 1;
+      }
+    }
+    printf("Replay: level 18 game, %u frames (%.1f min), %d lines, %ld bytes, %.0f bytes/min, replayed in %.2f ms, seeks in %.1f us\n",
+           header->frameCount, header->frameCount / SIM_FRAME_RATE / 60.0, header->linesCleared, bytes,
+           bytes / (header->frameCount / SIM_FRAME_RATE / 60.0), seconds * 1e3, seekSeconds * 1e6);
+    totalBytes += bytes;
+    totalFrames += header->frameCount;
+    ReplayReaderDestroy(reader);
+    fclose(file);
+  }
+  printf("Replay: %.2f bits per frame over %d games\n", 8.0 * totalBytes / totalFrames, GAME_COUNT);
+  BotDestroy(bot);
+
+  // random holds and taps of every length, read back frame by frame
+  static uint8_t inputs[RANDOM_FRAMES];
+  Rng rng;
+  RngSeed(&rng, 3);
+  for (int frame = 0; frame < RANDOM_FRAMES;) {
+    const int length = RngRange(&rng, 0, 3) == 0 ? RngRange(&rng, 1, 400) : RngRange(&rng, 1, 12);
+    const uint8_t first = RngRange(&rng, 0, 31);
+    const uint8_t second = RngRange(&rng, 0, 1) ? first : RngRange(&rng, 0, 31);
+    for (int i = 0; i < length && frame < RANDOM_FRAMES; i++, frame++) {
+      inputs[frame] = i % 2 ? second : first;
+    }
+  }
+  static SimState state;
+  SimReset(&state, 1);
+  SimStart(&state, 0);
+  FILE *file = tmpfile();
+  ReplayWriter *writer = file ? ReplayWriterCreate(file, 1, &state, REPLAY_KEYFRAME_INTERVAL) : NULL;
+  if (!writer) {
+    fprintf(stderr, "couldn't create a replay\n");
+    return 1;
+  }
+  for (int frame = 0; frame < RANDOM_FRAMES; frame++) {
+    ReplayWriterAdd(writer, inputs[frame], &state);
+  }
+  ReplayWriterFinish(writer, &state);
+  rewind(file);
+  ReplayReader *reader = ReplayReaderCreate(file);
+  uint8_t input;
+  for (int frame = 0; frame < RANDOM_FRAMES; frame++) {
+    if (!ReplayReaderNext(reader, &input) || input != inputs[frame]) {
+      fprintf(stderr, "random inputs read back wrong at frame %d\n", frame);
+      return 1;
+    }
+  }
+  if (ReplayReaderNext(reader, &input)) {
+    fprintf(stderr, "random inputs read back with extra frames\n");
+    return 1;
+  }
+  ReplayReaderDestroy(reader);
+  fclose(file);
+  return 0;
+}
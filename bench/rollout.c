@@ -0,0 +1,64 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bot/rollout.h"
+
+#define ROLLOUT_COUNT 2048
+#define PIECE_LIMIT 100
+
+static double NowSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void RunRollouts(int threads, const SimState *start, const RolloutConfig *config, RolloutResult *result, double *seconds) {
+  Pool *pool = PoolCreate(threads);
+  RolloutEvaluator *evaluator = RolloutCreate(pool);
+  const double begin = NowSeconds();
+  RolloutRun(evaluator, start, config, result);
+  *seconds = NowSeconds() - begin;
+  RolloutDestroy(evaluator);
+  PoolDestroy(pool);
+}
+
+int main(void) {
+  static SimState start;
+  SimReset(&start, 11);
+  SimStart(&start, 18);
+  const RolloutConfig config = {
+      .rolloutCount = ROLLOUT_COUNT,
+      .pieceLimit = PIECE_LIMIT,
+      .randomness = 0.1f,
+      .seed = 5,
+      .weights = NULL,
+  };
+
+  // totals must not depend on how the rollouts were spread over threads
+  RolloutResult serial;
+  RolloutResult parallel;
+  double seconds;
+  RunRollouts(1, &start, &config, &serial, &seconds);
+  RunRollouts(4, &start, &config, &parallel, &seconds);
+  if (memcmp(&serial, &parallel, sizeof(RolloutResult)) != 0) {
+    fprintf(stderr, "rollout totals differ between 1 and 4 threads\n");
+    return 1;
+  }
+  printf("Rollouts: %ld x %d pieces, %.1f lines, %.2f tetrises, %.1f%% topped out, %.0f points on average\n", serial.rollouts, PIECE_LIMIT,
+         (double)serial.linesCleared / serial.rollouts, (double)serial.tetrises / serial.rollouts, 100.0 * serial.topOuts / serial.rollouts,
+         (double)serial.score / serial.rollouts);
+
+  const int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  double baseline = 0.0;
+  for (int threads = 1; threads <= 32 && threads <= cores; threads *= 2) {
+    RolloutResult result;
+    RunRollouts(threads, &start, &config, &result, &seconds);
+    const double rolloutsPerSecond = result.rollouts / seconds;
+    baseline = threads == 1 ? rolloutsPerSecond : baseline;
+    printf("RolloutRun: %2d threads (%d cores), %.0f rollouts/s, %.0f pieces/s, %.2fx\n", threads, cores, rolloutsPerSecond,
+           result.pieces / seconds, rolloutsPerSecond / baseline);
+  }
+  return 0;
+}
@@ -0,0 +1,63 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "core/snapshot.h"
+
+#define ITERATIONS 10000000
+
+static double NowSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+int main(void) {
+  static SimState state;
+  static SimSnapshot snapshots[64];
+  SimReset(&state, 1);
+  SimStart(&state, 5);
+  // random play until the board has something on it
+  Rng inputs;
+  RngSeed(&inputs, 2);
+  uint8_t input = 0;
+  for (int frame = 0; frame < 3000 && !state.isGameOver; frame++) {
+    if (RngRange(&inputs, 0, 7) == 0) {
+      input = RngRange(&inputs, 0, 31);
+    }
+    SimStep(&state, input);
+  }
+
+  if (state.hash != SimComputeHash(&state)) {
+    fprintf(stderr, "incremental hash mismatch\n");
+    return 1;
+  }
+
+  SimSave(&state, &snapshots[0]);
+  static SimState restored;
+  SimRestore(&restored, &snapshots[0]);
+  SimSave(&restored, &snapshots[1]);
+  if (memcmp(&snapshots[0], &snapshots[1], sizeof(SimSnapshot)) != 0) {
+    fprintf(stderr, "snapshot round trip mismatch\n");
+    return 1;
+  }
+
+  double start = NowSeconds();
+  for (int i = 0; i < ITERATIONS; i++) {
+    SimSave(&state, &snapshots[i % 64]);
+    __asm__ volatile("" : : "r"(&snapshots[i % 64]) : "memory");
+  }
+  const double saveElapsed = NowSeconds() - start;
+
+  start = NowSeconds();
+  for (int i = 0; i < ITERATIONS; i++) {
+    SimRestore(&restored, &snapshots[i % 64]);
+    __asm__ volatile("" : : "r"(&restored) : "memory");
+  }
+  const double restoreElapsed = NowSeconds() - start;
+
+  printf("SimSnapshot: %zu bytes (SimState is %zu bytes)\n", sizeof(SimSnapshot), sizeof(SimState));
+  printf("SimSave: %.1f M snapshots/s, %.1f ns each\n", ITERATIONS / saveElapsed / 1e6, saveElapsed * 1e9 / ITERATIONS);
+  printf("SimRestore: %.1f M restores/s, %.1f ns each\n", ITERATIONS / restoreElapsed / 1e6, restoreElapsed * 1e9 / ITERATIONS);
+  return 0;
+}
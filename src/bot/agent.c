@@ -0,0 +1,262 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../core/sim.h"
+#include "../core/snapshot.h"
+#include "agent.h"
+#include "ring.h"
+
+#define AGENT_RING_CAPACITY 8
+// polls before the search thread goes to sleep, a new piece is never far off while the bot plays
+#define AGENT_SPIN_COUNT 20000
+// the game thread never waits on the mutex, so a wake up it couldn't deliver is picked up after this long
+#define AGENT_SLEEP_NS 2000000
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AGENT_PAUSE() __builtin_ia32_pause()
+#else
+#define AGENT_PAUSE() ((void)0)
+#endif
+
+typedef struct {
+  uint32_t sequence;
+  // a landed piece, plan the next one by deadline (CLOCK_MONOTONIC seconds)
+  bool isAhead;
+  double deadline;
+  SimSnapshot snapshot;
+} AgentRequest;
+
+typedef struct {
+  uint32_t sequence;
+  bool hasTarget;
+  Placement target;
+  BotMoveStats move;
+} AgentPlan;
+
+struct Agent {
+  // the search thread's, once it runs
+  Bot *bot;
+  SimState state;
+  Ring *requests;
+  Ring *plans;
+  pthread_t thread;
+  bool hasThread;
+  pthread_mutex_t mutex;
+  pthread_cond_t wake;
+  bool isSleeping;
+  bool isStopping;
+
+  // the game thread's
+  BotController controller;
+  int pieceCount;
+  // only the plan answering the latest request is used, anything older is for a piece that's gone
+  uint32_t sequence;
+  bool isWaiting;
+  bool isLate;
+  bool isThinkingAhead;
+  // the latest request was sent on landing, it's for the piece that hasn't spawned yet
+  bool isAheadPending;
+  AgentStats stats;
+};
+
+static void AgentRequestPlan(Agent *agent, const SimState *state, bool isAhead);
+static void *AgentMain(void *arg);
+static void AgentSleep(Agent *agent);
+static double AgentNowSeconds(void);
+
+// Without threads (e.g. a web build without pthreads) the agent searches on the calling thread like BotGetInput
+Agent *AgentCreate(const BotConfig *config) {
+  Agent *agent = calloc(1, sizeof(Agent));
+  if (!agent) {
+    return NULL;
+  }
+  pthread_mutex_init(&agent->mutex, NULL);
+  pthread_cond_init(&agent->wake, NULL);
+  agent->bot = BotCreate(config);
+  agent->requests = RingCreate(AGENT_RING_CAPACITY, sizeof(AgentRequest));
+  agent->plans = RingCreate(AGENT_RING_CAPACITY, sizeof(AgentPlan));
+  if (!agent->bot || !agent->requests || !agent->plans) {
+    AgentDestroy(agent);
+    return NULL;
+  }
+  agent->hasThread = pthread_create(&agent->thread, NULL, AgentMain, agent) == 0;
+  agent->isThinkingAhead = agent->hasThread;
+  AgentReset(agent);
+  return agent;
+}
+
+void AgentDestroy(Agent *agent) {
+  if (!agent) {
+    return;
+  }
+  if (agent->hasThread) {
+    pthread_mutex_lock(&agent->mutex);
+    __atomic_store_n(&agent->isStopping, true, __ATOMIC_RELAXED);
+    pthread_cond_signal(&agent->wake);
+    pthread_mutex_unlock(&agent->mutex);
+    pthread_join(agent->thread, NULL);
+  }
+  pthread_mutex_destroy(&agent->mutex);
+  pthread_cond_destroy(&agent->wake);
+  BotDestroy(agent->bot);
+  RingDestroy(agent->requests);
+  RingDestroy(agent->plans);
+  free(agent);
+}
+
+// forget the piece being controlled, call it whenever the SimState it plays is reset
+void AgentReset(Agent *agent) {
+  agent->pieceCount = 0;
+  agent->sequence++;
+  agent->isWaiting = false;
+  agent->isLate = false;
+  agent->isAheadPending = false;
+  BotControllerSetTarget(&agent->controller, NULL);
+}
+
+// On by default when the agent has its thread. The deadline is in real time, so anything stepping faster than SIM_FRAME_RATE should
+// turn it off and have every piece planned when it spawns instead.
+void AgentSetThinkingAhead(Agent *agent, bool isThinkingAhead) {
+  agent->isThinkingAhead = isThinkingAhead && agent->hasThread;
+  agent->isAheadPending = false;
+}
+
+// The buttons to hold this frame, never blocks. A new piece without a plan sends a request and presses nothing until it comes back.
+uint8_t AgentGetInput(Agent *agent, const SimState *state) {
+  if (state->isGameOver) {
+    return 0;
+  }
+  const int pieceCount = BotGetPieceCount(state);
+  if (pieceCount != agent->pieceCount) {
+    agent->pieceCount = pieceCount;
+    // the request sent when the last piece landed is this piece's
+    if (agent->isAheadPending) {
+      agent->isAheadPending = false;
+    } else if (!agent->hasThread) {
+      Placement target;
+      BotControllerSetTarget(&agent->controller, BotDecide(agent->bot, state, &target) ? &target : NULL);
+    } else {
+      AgentRequestPlan(agent, state, false);
+      return 0;
+    }
+  } else if (agent->isThinkingAhead && !agent->isAheadPending && state->ARETimer > 0 && state->animationTimer == 0) {
+    AgentRequestPlan(agent, state, true);
+    return 0;
+  }
+
+  if (AgentPoll(agent)) {
+    if (!agent->isAheadPending) {
+      agent->stats.lateFrames++;
+      agent->isLate = true;
+    }
+    return 0;
+  }
+  return BotControllerGetInput(&agent->controller, state);
+}
+
+// Takes in the plans that came back, true while the latest request is still out
+bool AgentPoll(Agent *agent) {
+  AgentPlan plan;
+  while (RingPop(agent->plans, &plan)) {
+    if (agent->isWaiting && plan.sequence == agent->sequence) {
+      agent->isWaiting = false;
+      agent->stats.plans++;
+      agent->stats.latePlans += agent->isLate;
+      agent->stats.depthCounts[plan.move.depth]++;
+      agent->stats.nodes += plan.move.nodes;
+      BotControllerSetTarget(&agent->controller, plan.hasTarget ? &plan.target : NULL);
+    }
+  }
+  return agent->isWaiting;
+}
+
+// The controller has nothing to do until the plan is in, any plan still out is for a piece that's gone
+static void AgentRequestPlan(Agent *agent, const SimState *state, bool isAhead) {
+  agent->sequence++;
+  agent->isWaiting = false;
+  agent->isLate = false;
+  agent->isAheadPending = isAhead;
+  BotControllerSetTarget(&agent->controller, NULL);
+  AgentRequest request = {.sequence = agent->sequence, .isAhead = isAhead};
+  if (isAhead) {
+    request.deadline = AgentNowSeconds() + SimGetFramesUntilSpawn(state) / SIM_FRAME_RATE;
+  }
+  SimSave(state, &request.snapshot);
+  if (!RingPush(agent->requests, &request)) {
+    agent->stats.droppedRequests++;
+    return;
+  }
+  agent->stats.requests++;
+  agent->isWaiting = true;
+  // a search thread holding the mutex is about to check the ring or sleep briefly, either way it finds the request
+  if (__atomic_load_n(&agent->isSleeping, __ATOMIC_SEQ_CST) && pthread_mutex_trylock(&agent->mutex) == 0) {
+    pthread_cond_signal(&agent->wake);
+    pthread_mutex_unlock(&agent->mutex);
+  }
+}
+
+// game thread only
+const AgentStats *AgentGetStats(const Agent *agent) { return &agent->stats; }
+
+// Only the newest request is searched, the pieces of older ones are gone by the time a search would finish
+static void *AgentMain(void *arg) {
+  Agent *agent = arg;
+  AgentRequest request;
+  int spinsLeft = 0;
+  while (!__atomic_load_n(&agent->isStopping, __ATOMIC_RELAXED)) {
+    bool hasRequest = false;
+    while (RingPop(agent->requests, &request)) {
+      hasRequest = true;
+    }
+    if (!hasRequest) {
+      if (spinsLeft > 0) {
+        spinsLeft--;
+        AGENT_PAUSE();
+      } else {
+        AgentSleep(agent);
+      }
+      continue;
+    }
+    spinsLeft = AGENT_SPIN_COUNT;
+    SimRestore(&agent->state, &request.snapshot);
+    AgentPlan plan = {.sequence = request.sequence};
+    if (request.isAhead) {
+      plan.hasTarget = BotDecideAhead(agent->bot, &agent->state, request.deadline, &plan.target);
+    } else {
+      plan.hasTarget = BotDecide(agent->bot, &agent->state, &plan.target);
+    }
+    if (plan.hasTarget) {
+      plan.move = agent->bot->lastMove;
+    }
+    // a full ring means the game thread isn't reading plans, it would drop this one anyway
+    RingPush(agent->plans, &plan);
+  }
+  return NULL;
+}
+
+static void AgentSleep(Agent *agent) {
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_nsec += AGENT_SLEEP_NS;
+  if (deadline.tv_nsec >= 1000000000) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000;
+  }
+  pthread_mutex_lock(&agent->mutex);
+  __atomic_store_n(&agent->isSleeping, true, __ATOMIC_SEQ_CST);
+  int result = 0;
+  while (result != ETIMEDOUT && !__atomic_load_n(&agent->isStopping, __ATOMIC_RELAXED) && RingIsEmpty(agent->requests)) {
+    result = pthread_cond_timedwait(&agent->wake, &agent->mutex, &deadline);
+  }
+  __atomic_store_n(&agent->isSleeping, false, __ATOMIC_RELAXED);
+  pthread_mutex_unlock(&agent->mutex);
+}
+
+static double AgentNowSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
@@ -0,0 +1,37 @@
+#ifndef AGENT_H
+#define AGENT_H
+
+#include <stdint.h>
+
+#include "../core/sim.h"
+#include "bot.h"
+
+typedef struct {
+  long requests;
+  long plans;
+  // ticks spent waiting for a plan after the first, the search had a whole frame and didn't make it
+  long lateFrames;
+  // plans that came in after at least one late frame
+  long latePlans;
+  // new pieces that found the request ring full, they are played without a plan
+  long droppedRequests;
+  // plans by the number of pieces their search placed, and the boards it evaluated
+  long depthCounts[BOT_MAX_DEPTH + 1];
+  long nodes;
+} AgentStats;
+
+// A bot searching on its own thread. The game thread sends it a snapshot for every new piece and picks up the placements it
+// sends back, both through lock-free rings, so a slow search costs the piece some frames instead of stalling the game.
+// Thinking ahead, the snapshot goes out as soon as a piece lands and BotDecideAhead plans the next one during the entry delay,
+// searching deeper until that piece spawns.
+typedef struct Agent Agent;
+
+Agent *AgentCreate(const BotConfig *config);
+void AgentDestroy(Agent *agent);
+void AgentReset(Agent *agent);
+uint8_t AgentGetInput(Agent *agent, const SimState *state);
+bool AgentPoll(Agent *agent);
+void AgentSetThinkingAhead(Agent *agent, bool isThinkingAhead);
+const AgentStats *AgentGetStats(const Agent *agent);
+
+#endif // AGENT_H
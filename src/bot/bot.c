@@ -0,0 +1,701 @@
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../core/util.h"
+#include "../core/zobrist.h"
+#include "bot.h"
+
+#define BOT_STATE_INDEX(ROTATION, X, Y) (((ROTATION) * 16 + (X) + BOARD_WALL_WIDTH) * ROWS + (Y))
+#define BOT_PRUNE_MARGIN 1e-3f
+
+static bool BotSetCandidates(Bot *bot, const Board *board, uint64_t boardHash, const Piece *piece);
+static int BotGetBestCandidate(const Bot *bot, int count);
+static void BotFinishMove(Bot *bot, double start, long startNodes, int depth);
+static void BotExpandCandidate(void *context, int index, int worker);
+static float BotGetBestScore(Bot *bot, BotWorker *scratch, const Board *board, uint64_t hash, int type);
+static void BotExpectimax(Bot *bot, int beamWidth);
+static void BotExpandChanceNodes(void *context, int index, int worker);
+static void BotSearchChanceNodes(Bot *bot, int previousType, int depth);
+static void BotSearchBranch(void *context, int index, int worker);
+static float BotGetMaxScore(Bot *bot, BotWorker *scratch, const Board *board, uint64_t hash, int type, int depth);
+static bool BotIsPastDeadline(Bot *bot);
+static float BotGetChanceBound(const EvalWeights *weights, const Board *board, int pieces);
+static uint64_t BotHashPlacement(uint64_t parentHash, const Board *board, int type, const Placement *placement, int linesCleared);
+static int BotCompareChanceNodes(const void *a, const void *b);
+static int BotCompareCandidates(const void *a, const void *b);
+static bool BotPlanPath(BotController *controller, const Board *board, const Piece *piece);
+static double BotNowSeconds(void);
+
+const BotConfig botDefaultConfig = {
+    .threadCount = 0,
+    .decisionsPerSecond = 0.0,
+    .maxBeamWidth = 16,
+    .search = BOT_SEARCH_BEAM,
+    .weights = NULL,
+    .transpositionBytes = 16 << 20,
+};
+
+// threadCount 0 or less uses every online core
+Bot *BotCreate(const BotConfig *config) {
+  Bot *bot = calloc(1, sizeof(Bot));
+  if (!bot) {
+    return NULL;
+  }
+  bot->config = *config;
+  bot->weights = config->weights ? *config->weights : evalDefaultWeights;
+  bot->config.weights = &bot->weights;
+  if (bot->config.threadCount <= 0) {
+    bot->config.threadCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  bot->config.maxBeamWidth = bot->config.maxBeamWidth < 1 ? 1 : MIN(bot->config.maxBeamWidth, BOT_MAX_BEAM_WIDTH);
+  bot->pool = PoolCreate(bot->config.threadCount);
+  bot->evalPath = EvalGetBestPath();
+  bot->workers = calloc(PoolThreadCount(bot->pool), sizeof(BotWorker));
+  if (bot->config.transpositionBytes > 0) {
+    bot->transpositions = TranspositionCreate(bot->config.transpositionBytes);
+  }
+  if (!bot->workers || (bot->config.transpositionBytes > 0 && !bot->transpositions)) {
+    BotDestroy(bot);
+    return NULL;
+  }
+  bot->beamWidth = bot->config.maxBeamWidth;
+  BotReset(bot);
+  return bot;
+}
+
+void BotDestroy(Bot *bot) {
+  if (!bot) {
+    return;
+  }
+  PoolDestroy(bot->pool);
+  TranspositionDestroy(bot->transpositions);
+  free(bot->workers);
+  free(bot);
+}
+
+// forget the piece being controlled, call it whenever the SimState it plays is reset
+void BotReset(Bot *bot) {
+  bot->pieceCount = 0;
+  BotControllerSetTarget(&bot->controller, NULL);
+}
+
+// Cached scores were computed under the old weights, so the transposition table is cleared with them
+void BotSetWeights(Bot *bot, const EvalWeights *weights) {
+  bot->weights = *weights;
+  if (bot->transpositions) {
+    TranspositionClear(bot->transpositions);
+  }
+}
+
+// Beam search over two plies: every placement of the current piece is scored on its own, the best beamWidth of them are expanded
+// with every placement of the next piece in parallel, and the one leading to the best board wins. BOT_SEARCH_EXPECTIMAX goes on
+// to the unknown third piece from there.
+// Returns false when the current piece has nowhere to go.
+bool BotDecide(Bot *bot, const SimState *state, Placement *placement) {
+  const double start = BotNowSeconds();
+  const long startNodes = bot->stats.nodes;
+  // the state hash covers the current piece type too, without it it's the hash of the board alone
+  const uint64_t boardHash = state->hash ^ ZobristPieceType(state->currentPiece.type);
+  if (!BotSetCandidates(bot, &state->board, boardHash, &state->currentPiece)) {
+    return false;
+  }
+
+  const int beamWidth = MIN(bot->beamWidth, bot->candidateCount);
+  bot->nextType = state->nextPiece.type;
+  bot->deadline = 0.0;
+  if (bot->config.search == BOT_SEARCH_EXPECTIMAX) {
+    BotExpectimax(bot, beamWidth);
+  } else {
+    PoolRun(bot->pool, beamWidth, BotExpandCandidate, bot);
+  }
+  *placement = bot->candidates[BotGetBestCandidate(bot, beamWidth)].placement;
+  BotFinishMove(bot, start, startNodes, bot->config.search == BOT_SEARCH_EXPECTIMAX ? 3 : 2);
+
+  if (bot->config.decisionsPerSecond > 0.0) {
+    const double budget = 1.0 / bot->config.decisionsPerSecond;
+    if (bot->lastMove.seconds > budget) {
+      bot->beamWidth = MAX(1, bot->beamWidth * 3 / 4);
+    } else if (bot->lastMove.seconds < budget / 2.0) {
+      bot->beamWidth = MIN(bot->config.maxBeamWidth, bot->beamWidth + 1);
+    }
+  }
+  return true;
+}
+
+// Plans the next piece while the current one, already landed, waits out its entry delay (state->ARETimer is counting).
+// The root is the board the current piece leaves behind and the piece after the next one isn't shown yet, so every beam candidate
+// is a chance node over it. Iterative deepening: each iteration places one more piece, averaging over every hidden one, until
+// deadline (CLOCK_MONOTONIC seconds). The deepest iteration that finished wins, at worst the best placement on its own.
+// Returns false when the next piece has nowhere to go.
+bool BotDecideAhead(Bot *bot, const SimState *state, double deadline, Placement *placement) {
+  const double start = BotNowSeconds();
+  const long startNodes = bot->stats.nodes;
+  const Piece *current = &state->currentPiece;
+  const Placement lock = {current->x, current->y, current->rotationIndex};
+  Board board = state->board;
+  const int linesCleared = MovegenApplyPlacement(&board, current->type, &lock);
+  const uint64_t boardHash = BotHashPlacement(state->hash ^ ZobristPieceType(current->type), &board, current->type, &lock, linesCleared);
+  const Piece nextPiece = {state->nextPiece.type, INITIAL_BOARD_X, INITIAL_BOARD_Y, INITIAL_ROTATION};
+  if (!PieceFits(&board, nextPiece.type, nextPiece.rotationIndex, nextPiece.x, nextPiece.y) ||
+      !BotSetCandidates(bot, &board, boardHash, &nextPiece)) {
+    return false;
+  }
+  *placement = bot->candidates[0].placement;
+  int depth = 1;
+
+  const int beamWidth = MIN(bot->beamWidth, bot->candidateCount);
+  bot->deadline = deadline;
+  for (int iteration = 2; iteration <= BOT_MAX_DEPTH && BotNowSeconds() < deadline; iteration++) {
+    bot->chanceNodeCount = beamWidth;
+    for (int i = 0; i < beamWidth; i++) {
+      const BotCandidate *candidate = &bot->candidates[i];
+      BotChanceNode *node = &bot->chanceNodes[i];
+      node->board = candidate->board;
+      node->hash = candidate->hash;
+      node->parent = i;
+      node->staticScore = candidate->score;
+      node->base = candidate->linesCleared > 0 ? bot->weights.lineClears[candidate->linesCleared - 1] : 0.0f;
+      node->bound = BotGetChanceBound(&bot->weights, &node->board, iteration - 1);
+      node->doneBranches = 0;
+      node->isPruned = false;
+    }
+    BotSearchChanceNodes(bot, nextPiece.type, iteration - 1);
+    if (bot->isAborted) {
+      break;
+    }
+    *placement = bot->candidates[BotGetBestCandidate(bot, beamWidth)].placement;
+    depth = iteration;
+  }
+  bot->deadline = 0.0;
+  BotFinishMove(bot, start, startNodes, depth);
+  return true;
+}
+
+// Picks a placement for every new piece and returns the buttons to hold this frame to get there
+uint8_t BotGetInput(Bot *bot, const SimState *state) {
+  if (state->isGameOver) {
+    return 0;
+  }
+  const int pieceCount = BotGetPieceCount(state);
+  if (pieceCount != bot->pieceCount) {
+    bot->pieceCount = pieceCount;
+    Placement target;
+    BotControllerSetTarget(&bot->controller, BotDecide(bot, state, &target) ? &target : NULL);
+  }
+  return BotControllerGetInput(&bot->controller, state);
+}
+
+// NULL when the piece has nowhere to go, the controller then presses nothing
+void BotControllerSetTarget(BotController *controller, const Placement *target) {
+  controller->hasTarget = target != NULL;
+  controller->isPathValid = false;
+  if (target) {
+    controller->target = *target;
+  }
+}
+
+// The buttons to hold this frame to get the current piece to the target.
+// Moves only happen on fresh presses, so repeating a button takes a frame with it released in between.
+uint8_t BotControllerGetInput(BotController *controller, const SimState *state) {
+  if (!controller->hasTarget || state->isGameOver || state->ARETimer != 0 || state->animationTimer != 0) {
+    return 0;
+  }
+
+  // gravity moved the piece off the planned path, plan again from where it is
+  const Piece *piece = &state->currentPiece;
+  const Piece *expected = &controller->pathPieces[controller->pathIndex];
+  if (!controller->isPathValid || piece->x != expected->x || piece->y != expected->y || piece->rotationIndex != expected->rotationIndex) {
+    controller->isPathValid = BotPlanPath(controller, &state->board, piece);
+    if (!controller->isPathValid) {
+      controller->hasTarget = false;
+      return 0;
+    }
+  }
+
+  // once there, soft drop to lock right away
+  const uint8_t button = controller->pathIndex < controller->pathLength ? controller->path[controller->pathIndex] : INPUT_DOWN;
+  if (state->previousInput & button) {
+    return 0;
+  }
+  if (controller->pathIndex < controller->pathLength) {
+    controller->pathIndex++;
+  }
+  return button;
+}
+
+// Every spawned piece is counted in the statistics, so the sum changes exactly when a new piece comes in
+int BotGetPieceCount(const SimState *state) {
+  int pieceCount = 0;
+  for (int i = 0; i < PIECE_COUNT; i++) {
+    pieceCount += state->statistics[i];
+  }
+  return pieceCount;
+}
+
+// Every placement of piece on board, scored on its own and sorted best first. False when there are none.
+static bool BotSetCandidates(Bot *bot, const Board *board, uint64_t boardHash, const Piece *piece) {
+  PlacementList *list = &bot->workers[0].list;
+  MovegenPlacements(board, piece, list);
+  bot->candidateCount = list->count;
+  for (int i = 0; i < list->count; i++) {
+    BotCandidate *candidate = &bot->candidates[i];
+    candidate->board = *board;
+    candidate->placement = list->placements[i];
+    candidate->linesCleared = MovegenApplyPlacement(&candidate->board, piece->type, &candidate->placement);
+    candidate->hash = BotHashPlacement(boardHash, &candidate->board, piece->type, &candidate->placement, candidate->linesCleared);
+    candidate->score = EvalBoard(&candidate->board, candidate->linesCleared, &bot->weights);
+  }
+  bot->stats.nodes += list->count;
+  qsort(bot->candidates, bot->candidateCount, sizeof(BotCandidate), BotCompareCandidates);
+  return list->count > 0;
+}
+
+// the first of the best, so ties always go the same way
+static int BotGetBestCandidate(const Bot *bot, int count) {
+  int best = 0;
+  for (int i = 1; i < count; i++) {
+    if (bot->candidates[i].score > bot->candidates[best].score) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+static void BotFinishMove(Bot *bot, double start, long startNodes, int depth) {
+  if (bot->transpositions) {
+    TranspositionNextGeneration(bot->transpositions);
+  }
+  for (int i = 0; i < PoolThreadCount(bot->pool); i++) {
+    BotWorker *worker = &bot->workers[i];
+    bot->stats.transpositionProbes += worker->transpositionProbes;
+    bot->stats.transpositionHits += worker->transpositionHits;
+    bot->stats.nodes += worker->nodes;
+    bot->stats.prunedBranches += worker->prunedBranches;
+    worker->transpositionProbes = 0;
+    worker->transpositionHits = 0;
+    worker->nodes = 0;
+    worker->prunedBranches = 0;
+  }
+  const double elapsed = BotNowSeconds() - start;
+  bot->stats.decisions++;
+  bot->stats.totalSeconds += elapsed;
+  bot->stats.lastSeconds = elapsed;
+  bot->stats.depthCounts[depth]++;
+  bot->lastMove = (BotMoveStats){depth, bot->stats.nodes - startNodes, elapsed};
+}
+
+static void BotExpandCandidate(void *context, int index, int worker) {
+  Bot *bot = context;
+  BotCandidate *candidate = &bot->candidates[index];
+  const float lineReward = candidate->linesCleared > 0 ? bot->weights.lineClears[candidate->linesCleared - 1] : 0.0f;
+  candidate->score = BotGetBestScore(bot, &bot->workers[worker], &candidate->board, candidate->hash, bot->nextType) + lineReward;
+}
+
+// The score of the best board a piece of the given type can reach, -FLT_MAX when it can't spawn since that's a game over.
+// It only depends on the board and the type, other candidates and earlier decisions often ask for the same one.
+static float BotGetBestScore(Bot *bot, BotWorker *scratch, const Board *board, uint64_t hash, int type) {
+  const Piece piece = {type, INITIAL_BOARD_X, INITIAL_BOARD_Y, INITIAL_ROTATION};
+  if (!PieceFits(board, piece.type, piece.rotationIndex, piece.x, piece.y)) {
+    return -FLT_MAX;
+  }
+  const uint64_t key = hash ^ ZobristPieceType(type);
+  float best;
+  if (bot->transpositions) {
+    scratch->transpositionProbes++;
+    if (TranspositionProbe(bot->transpositions, key, 1, &best)) {
+      scratch->transpositionHits++;
+      return best;
+    }
+  }
+
+  MovegenPlacements(board, &piece, &scratch->list);
+  scratch->nodes += scratch->list.count;
+  best = -FLT_MAX;
+  for (int start = 0; start < scratch->list.count; start += EVAL_BATCH_SIZE) {
+    scratch->batch.count = MIN(EVAL_BATCH_SIZE, scratch->list.count - start);
+    for (int i = 0; i < scratch->batch.count; i++) {
+      Board next = *board;
+      const int linesCleared = MovegenApplyPlacement(&next, type, &scratch->list.placements[start + i]);
+      EvalBatchSetBoard(&scratch->batch, i, &next, linesCleared);
+    }
+    EvalBatchScore(&scratch->batch, &bot->weights, bot->evalPath, scratch->scores);
+    for (int i = 0; i < scratch->batch.count; i++) {
+      best = MAX(best, scratch->scores[i]);
+    }
+  }
+  if (bot->transpositions) {
+    TranspositionStore(bot->transpositions, key, 1, best);
+  }
+  return best;
+}
+
+// Expectimax over the third piece: every candidate in the beam keeps its best BOT_EXPECTIMAX_WIDTH next piece placements as chance
+// nodes, and each chance node averages the best score of all seven third pieces. The branches are the parallel tasks, searched best
+// node first so the cutoff rises early, and a branch is skipped once its node can't beat the best finished node even if every branch
+// left reached the node's bound (Star1 pruning).
+static void BotExpectimax(Bot *bot, int beamWidth) {
+  PoolRun(bot->pool, beamWidth, BotExpandChanceNodes, bot);
+  bot->chanceNodeCount = 0;
+  for (int i = 0; i < beamWidth; i++) {
+    for (int j = 0; j < bot->chanceNodeCounts[i]; j++) {
+      bot->chanceNodes[bot->chanceNodeCount++] = bot->chanceNodes[i * BOT_EXPECTIMAX_WIDTH + j];
+    }
+  }
+  qsort(bot->chanceNodes, bot->chanceNodeCount, sizeof(BotChanceNode), BotCompareChanceNodes);
+  // candidates the next piece can't spawn on have no nodes
+  for (int i = 0; i < beamWidth; i++) {
+    bot->candidates[i].score = -FLT_MAX;
+  }
+  BotSearchChanceNodes(bot, bot->nextType, 1);
+}
+
+// Searches the branches of every chance node in parallel, each placing depth pieces, and scores every candidate with a node by the
+// best of its nodes. previousType is the piece rolled right before the hidden one.
+static void BotSearchChanceNodes(Bot *bot, int previousType, int depth) {
+  // a repeat of the previous piece needs the reroll to land on it again
+  int branch = 0;
+  for (int type = 0; type < PIECE_COUNT; type++) {
+    if (type != previousType) {
+      bot->branchTypes[branch] = type;
+      bot->branchWeights[branch++] = (PIECE_COUNT + 1.0f) / (PIECE_COUNT * PIECE_COUNT);
+    }
+  }
+  bot->branchTypes[branch] = previousType;
+  bot->branchWeights[branch] = 1.0f / (PIECE_COUNT * PIECE_COUNT);
+  bot->branchDepth = depth;
+  bot->alpha = -FLT_MAX;
+  bot->isAborted = false;
+  PoolRun(bot->pool, bot->chanceNodeCount * PIECE_COUNT, BotSearchBranch, bot);
+
+  // a node that was cut off is worth less than the best one, so its candidate can't win with it
+  for (int i = 0; i < bot->chanceNodeCount; i++) {
+    bot->candidates[bot->chanceNodes[i].parent].score = -FLT_MAX;
+  }
+  for (int i = 0; i < bot->chanceNodeCount; i++) {
+    const BotChanceNode *node = &bot->chanceNodes[i];
+    if (!node->isPruned && node->doneBranches == (1 << PIECE_COUNT) - 1) {
+      bot->candidates[node->parent].score = MAX(bot->candidates[node->parent].score, node->value);
+    }
+  }
+  bot->stats.chanceNodes += bot->chanceNodeCount;
+}
+
+static void BotExpandChanceNodes(void *context, int index, int worker) {
+  Bot *bot = context;
+  const BotCandidate *candidate = &bot->candidates[index];
+  BotChanceNode *nodes = &bot->chanceNodes[index * BOT_EXPECTIMAX_WIDTH];
+  BotWorker *scratch = &bot->workers[worker];
+  const Piece nextPiece = {bot->nextType, INITIAL_BOARD_X, INITIAL_BOARD_Y, INITIAL_ROTATION};
+  bot->chanceNodeCounts[index] = 0;
+  if (!PieceFits(&candidate->board, nextPiece.type, nextPiece.rotationIndex, nextPiece.x, nextPiece.y)) {
+    return;
+  }
+
+  // keeps the best placements sorted, ties go to the one generated first
+  int keptCount = 0;
+  int kept[BOT_EXPECTIMAX_WIDTH];
+  float keptScores[BOT_EXPECTIMAX_WIDTH];
+  MovegenPlacements(&candidate->board, &nextPiece, &scratch->list);
+  scratch->nodes += scratch->list.count;
+  for (int start = 0; start < scratch->list.count; start += EVAL_BATCH_SIZE) {
+    scratch->batch.count = MIN(EVAL_BATCH_SIZE, scratch->list.count - start);
+    for (int i = 0; i < scratch->batch.count; i++) {
+      Board board = candidate->board;
+      const int linesCleared = MovegenApplyPlacement(&board, nextPiece.type, &scratch->list.placements[start + i]);
+      EvalBatchSetBoard(&scratch->batch, i, &board, linesCleared);
+    }
+    EvalBatchScore(&scratch->batch, &bot->weights, bot->evalPath, scratch->scores);
+    for (int i = 0; i < scratch->batch.count; i++) {
+      if (keptCount == BOT_EXPECTIMAX_WIDTH && scratch->scores[i] <= keptScores[keptCount - 1]) {
+        continue;
+      }
+      int slot = keptCount < BOT_EXPECTIMAX_WIDTH ? keptCount++ : keptCount - 1;
+      for (; slot > 0 && keptScores[slot - 1] < scratch->scores[i]; slot--) {
+        kept[slot] = kept[slot - 1];
+        keptScores[slot] = keptScores[slot - 1];
+      }
+      kept[slot] = start + i;
+      keptScores[slot] = scratch->scores[i];
+    }
+  }
+
+  const float lineReward = candidate->linesCleared > 0 ? bot->weights.lineClears[candidate->linesCleared - 1] : 0.0f;
+  for (int i = 0; i < keptCount; i++) {
+    BotChanceNode *node = &nodes[i];
+    const Placement *placement = &scratch->list.placements[kept[i]];
+    node->board = candidate->board;
+    const int linesCleared = MovegenApplyPlacement(&node->board, nextPiece.type, placement);
+    node->hash = BotHashPlacement(candidate->hash, &node->board, nextPiece.type, placement, linesCleared);
+    node->parent = index;
+    node->staticScore = keptScores[i] + lineReward;
+    node->base = lineReward + (linesCleared > 0 ? bot->weights.lineClears[linesCleared - 1] : 0.0f);
+    node->bound = BotGetChanceBound(&bot->weights, &node->board, 1);
+    node->doneBranches = 0;
+    node->isPruned = false;
+  }
+  bot->chanceNodeCounts[index] = keptCount;
+}
+
+static void BotSearchBranch(void *context, int index, int worker) {
+  Bot *bot = context;
+  BotChanceNode *node = &bot->chanceNodes[index / PIECE_COUNT];
+  const int branch = index % PIECE_COUNT;
+  BotWorker *scratch = &bot->workers[worker];
+  if (__atomic_load_n(&node->isPruned, __ATOMIC_RELAXED)) {
+    scratch->prunedBranches++;
+    return;
+  }
+  if (BotIsPastDeadline(bot)) {
+    return;
+  }
+
+  // the margin keeps float rounding in the bound from cutting off a node that ties the best one
+  float alpha;
+  __atomic_load(&bot->alpha, &alpha, __ATOMIC_RELAXED);
+  const uint8_t doneBranches = __atomic_load_n(&node->doneBranches, __ATOMIC_ACQUIRE);
+  float bound = node->base;
+  for (int i = 0; i < PIECE_COUNT; i++) {
+    bound += bot->branchWeights[i] * (doneBranches & 1 << i ? node->values[i] : node->bound);
+  }
+  if (bound < alpha - BOT_PRUNE_MARGIN) {
+    __atomic_store_n(&node->isPruned, true, __ATOMIC_RELAXED);
+    scratch->prunedBranches++;
+    return;
+  }
+
+  node->values[branch] = BotGetMaxScore(bot, scratch, &node->board, node->hash, bot->branchTypes[branch], bot->branchDepth);
+  if (__atomic_load_n(&bot->isAborted, __ATOMIC_RELAXED)) {
+    return;
+  }
+  if (__atomic_or_fetch(&node->doneBranches, 1 << branch, __ATOMIC_ACQ_REL) != (1 << PIECE_COUNT) - 1) {
+    return;
+  }
+  // the last branch in sums them in a fixed order, so the value doesn't depend on which thread finished when
+  float value = node->base;
+  for (int i = 0; i < PIECE_COUNT; i++) {
+    value += bot->branchWeights[i] * node->values[i];
+  }
+  node->value = value;
+  __atomic_load(&bot->alpha, &alpha, __ATOMIC_RELAXED);
+  while (value > alpha && !__atomic_compare_exchange(&bot->alpha, &alpha, &value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+// The best score a piece of the given type can reach placing depth pieces, itself first, averaging over every piece after it that
+// isn't known yet. Below the root only the best BOT_EXPECTIMAX_WIDTH placements of each piece are followed.
+static float BotGetMaxScore(Bot *bot, BotWorker *scratch, const Board *board, uint64_t hash, int type, int depth) {
+  if (depth == 1) {
+    return BotGetBestScore(bot, scratch, board, hash, type);
+  }
+  const Piece piece = {type, INITIAL_BOARD_X, INITIAL_BOARD_Y, INITIAL_ROTATION};
+  if (!PieceFits(board, piece.type, piece.rotationIndex, piece.x, piece.y)) {
+    return -FLT_MAX;
+  }
+  const uint64_t key = hash ^ ZobristPieceType(type);
+  float best;
+  if (bot->transpositions) {
+    scratch->transpositionProbes++;
+    if (TranspositionProbe(bot->transpositions, key, depth, &best)) {
+      scratch->transpositionHits++;
+      return best;
+    }
+  }
+  if (BotIsPastDeadline(bot)) {
+    return -FLT_MAX;
+  }
+
+  int keptCount = 0;
+  Placement kept[BOT_EXPECTIMAX_WIDTH];
+  float keptScores[BOT_EXPECTIMAX_WIDTH];
+  MovegenPlacements(board, &piece, &scratch->list);
+  scratch->nodes += scratch->list.count;
+  for (int start = 0; start < scratch->list.count; start += EVAL_BATCH_SIZE) {
+    scratch->batch.count = MIN(EVAL_BATCH_SIZE, scratch->list.count - start);
+    for (int i = 0; i < scratch->batch.count; i++) {
+      Board next = *board;
+      const int linesCleared = MovegenApplyPlacement(&next, type, &scratch->list.placements[start + i]);
+      EvalBatchSetBoard(&scratch->batch, i, &next, linesCleared);
+    }
+    EvalBatchScore(&scratch->batch, &bot->weights, bot->evalPath, scratch->scores);
+    for (int i = 0; i < scratch->batch.count; i++) {
+      if (keptCount == BOT_EXPECTIMAX_WIDTH && scratch->scores[i] <= keptScores[keptCount - 1]) {
+        continue;
+      }
+      int slot = keptCount < BOT_EXPECTIMAX_WIDTH ? keptCount++ : keptCount - 1;
+      for (; slot > 0 && keptScores[slot - 1] < scratch->scores[i]; slot--) {
+        kept[slot] = kept[slot - 1];
+        keptScores[slot] = keptScores[slot - 1];
+      }
+      kept[slot] = scratch->list.placements[start + i];
+      keptScores[slot] = scratch->scores[i];
+    }
+  }
+
+  best = -FLT_MAX;
+  for (int i = 0; i < keptCount; i++) {
+    Board next = *board;
+    const int linesCleared = MovegenApplyPlacement(&next, type, &kept[i]);
+    const uint64_t nextHash = BotHashPlacement(hash, &next, type, &kept[i], linesCleared);
+    float value = linesCleared > 0 ? bot->weights.lineClears[linesCleared - 1] : 0.0f;
+    for (int nextType = 0; nextType < PIECE_COUNT; nextType++) {
+      const float weight = (nextType == type ? 1.0f : PIECE_COUNT + 1.0f) / (PIECE_COUNT * PIECE_COUNT);
+      value += weight * BotGetMaxScore(bot, scratch, &next, nextHash, nextType, depth - 1);
+    }
+    best = MAX(best, value);
+  }
+  // a search cut short by the deadline is missing branches, it can't go in the table
+  if (__atomic_load_n(&bot->isAborted, __ATOMIC_RELAXED)) {
+    return -FLT_MAX;
+  }
+  if (bot->transpositions) {
+    TranspositionStore(bot->transpositions, key, depth, best);
+  }
+  return best;
+}
+
+// Once one thread sees the deadline pass every other one stops at its next check too
+static bool BotIsPastDeadline(Bot *bot) {
+  if (bot->deadline <= 0.0) {
+    return false;
+  }
+  if (__atomic_load_n(&bot->isAborted, __ATOMIC_RELAXED)) {
+    return true;
+  }
+  if (BotNowSeconds() < bot->deadline) {
+    return false;
+  }
+  __atomic_store_n(&bot->isAborted, true, __ATOMIC_RELAXED);
+  return true;
+}
+
+// An upper bound on the best score placing the given number of pieces can reach from the board, from what they can't undo: heights
+// only drop by clearing lines and each piece fills at most 4 holes. Other features can improve without bound, so positive weights give
+// no bound.
+static float BotGetChanceBound(const EvalWeights *weights, const Board *board, int pieces) {
+  if (weights->aggregateHeight > 0.0f || weights->holes > 0.0f || weights->bumpiness > 0.0f || weights->wells > 0.0f ||
+      weights->rowTransitions > 0.0f) {
+    return FLT_MAX;
+  }
+  EvalFeatures features;
+  EvalGetFeatures(board, &features);
+  // a piece adds at most 4 cells to a row, so only rows that close to full can be cleared
+  bool canClear = false;
+  for (int y = 0; y < ROWS && !canClear; y++) {
+    canClear = __builtin_popcount(board->rows[y] & ~BOARD_EMPTY_ROW) >= COLUMNS - 4 * pieces;
+  }
+  if (!canClear) {
+    return weights->aggregateHeight * features.aggregateHeight + weights->holes * MAX(0, features.holes - 4 * pieces);
+  }
+  float lineReward = 0.0f;
+  for (int i = 0; i < 4; i++) {
+    lineReward = MAX(lineReward, weights->lineClears[i]);
+  }
+  return weights->aggregateHeight * MAX(0, features.aggregateHeight - 4 * pieces * COLUMNS) + pieces * lineReward;
+}
+
+// Zobrist hash of board after the placement, from the hash before it. Line clears move every row above them, so those rehash in full
+static uint64_t BotHashPlacement(uint64_t parentHash, const Board *board, int type, const Placement *placement, int linesCleared) {
+  if (linesCleared > 0) {
+    return ZobristBoard(board);
+  }
+  const PieceCell *cells = tetrominoes[type].rotations[placement->rotationIndex].cells;
+  uint64_t hash = parentHash;
+  for (int i = 0; i < 4; i++) {
+    hash ^= ZobristCell(placement->x + cells[i].x, placement->y + cells[i].y);
+  }
+  return hash;
+}
+
+// best first
+static int BotCompareChanceNodes(const void *a, const void *b) {
+  const float left = ((const BotChanceNode *)a)->staticScore;
+  const float right = ((const BotChanceNode *)b)->staticScore;
+  return (left < right) - (left > right);
+}
+
+// best first
+static int BotCompareCandidates(const void *a, const void *b) {
+  const float left = ((const BotCandidate *)a)->score;
+  const float right = ((const BotCandidate *)b)->score;
+  return (left < right) - (left > right);
+}
+
+// Breadth-first search over single moves from the piece to the target, fills path with the buttons to press
+static bool BotPlanPath(BotController *controller, const Board *board, const Piece *piece) {
+  static const uint8_t moves[] = {INPUT_ROTATE_CLOCKWISE, INPUT_ROTATE_COUNTER_CLOCKWISE, INPUT_LEFT, INPUT_RIGHT, INPUT_DOWN};
+  int16_t *parents = &controller->parents[0][0][0];
+  uint8_t *parentMoves = &controller->parentMoves[0][0][0];
+  memset(controller->parents, 0xFF, sizeof(controller->parents));
+
+  const int start = BOT_STATE_INDEX(piece->rotationIndex, piece->x, piece->y);
+  const int goal = BOT_STATE_INDEX(controller->target.rotationIndex, controller->target.x, controller->target.y);
+  int head = 0;
+  int tail = 0;
+  controller->queue[tail++] = start;
+  parents[start] = start;
+  while (head < tail && parents[goal] < 0) {
+    const int state = controller->queue[head++];
+    const int rotationIndex = state / (16 * ROWS);
+    const int x = state / ROWS % 16 - BOARD_WALL_WIDTH;
+    const int y = state % ROWS;
+    for (int i = 0; i < (int)sizeof(moves); i++) {
+      int nextRotation = rotationIndex;
+      int nextX = x;
+      int nextY = y;
+      switch (moves[i]) {
+      case INPUT_ROTATE_CLOCKWISE:
+        nextRotation = (rotationIndex + 1) & 3;
+        break;
+      case INPUT_ROTATE_COUNTER_CLOCKWISE:
+        nextRotation = (rotationIndex + 3) & 3;
+        break;
+      case INPUT_LEFT:
+        nextX--;
+        break;
+      case INPUT_RIGHT:
+        nextX++;
+        break;
+      default:
+        nextY++;
+        break;
+      }
+      if (nextX < -BOARD_WALL_WIDTH || nextX >= 16 - BOARD_WALL_WIDTH || nextY >= ROWS) {
+        continue;
+      }
+      const int next = BOT_STATE_INDEX(nextRotation, nextX, nextY);
+      if (parents[next] >= 0 || !PieceFits(board, piece->type, nextRotation, nextX, nextY)) {
+        continue;
+      }
+      parents[next] = state;
+      parentMoves[next] = moves[i];
+      controller->queue[tail++] = next;
+    }
+  }
+  if (parents[goal] < 0) {
+    return false;
+  }
+
+  controller->pathLength = 0;
+  for (int state = goal; state != start; state = parents[state]) {
+    controller->pathLength++;
+  }
+  int index = controller->pathLength;
+  for (int state = goal; index >= 0; state = parents[state]) {
+    controller->pathPieces[index] = (Piece){piece->type, state / ROWS % 16 - BOARD_WALL_WIDTH, state % ROWS, state / (16 * ROWS)};
+    if (index > 0) {
+      controller->path[index - 1] = parentMoves[state];
+    }
+    index--;
+  }
+  controller->pathIndex = 0;
+  return true;
+}
+
+static double BotNowSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
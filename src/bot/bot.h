@@ -0,0 +1,164 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../core/movegen.h"
+#include "../core/sim.h"
+#include "eval.h"
+#include "pool.h"
+#include "transposition.h"
+
+#define BOT_MAX_BEAM_WIDTH 64
+// every (rotation, x, y) state plus the start, a path can't be longer than that
+#define BOT_MAX_PATH_LENGTH (4 * 16 * ROWS)
+// next piece placements each candidate keeps as chance nodes in BOT_SEARCH_EXPECTIMAX, and placements each piece keeps below the
+// root in BotDecideAhead
+#define BOT_EXPECTIMAX_WIDTH 8
+// pieces placed by the deepest BotDecideAhead iteration
+#define BOT_MAX_DEPTH 5
+
+typedef enum {
+  // the current and the next piece, the only ones the game shows
+  BOT_SEARCH_BEAM,
+  // also averages over every third piece, weighted by how likely PieceGetRandom is to roll it
+  BOT_SEARCH_EXPECTIMAX,
+} BotSearch;
+
+typedef struct {
+  // threads searching in parallel, the caller included
+  int threadCount;
+  // the beam narrows when decisions take longer than 1 / decisionsPerSecond and widens while there's time left, 0 keeps it at maxBeamWidth
+  double decisionsPerSecond;
+  int maxBeamWidth;
+  BotSearch search;
+  // NULL for evalDefaultWeights
+  const EvalWeights *weights;
+  // memory for the transposition table shared by the search threads, 0 searches without one
+  size_t transpositionBytes;
+} BotConfig;
+
+// a placement of the current piece after the line clears it caused, ranked by how good the board looks on its own
+typedef struct {
+  Board board;
+  Placement placement;
+  // Zobrist hash of board, the same as ZobristBoard gives
+  uint64_t hash;
+  int linesCleared;
+  float score;
+} BotCandidate;
+
+typedef struct {
+  PlacementList list;
+  EvalBatch batch;
+  float scores[EVAL_BATCH_SIZE];
+  long transpositionProbes;
+  long transpositionHits;
+  long nodes;
+  long prunedBranches;
+} BotWorker;
+
+// A board after the current and the next piece, its value is the average over the third piece types of the best board each can reach.
+// BotDecideAhead makes one for every candidate instead, the piece after them is the one that's still hidden.
+typedef struct {
+  Board board;
+  uint64_t hash;
+  // index into Bot.candidates
+  int parent;
+  // EvalBoard of the board plus the line reward of the first move, orders the search so good nodes raise the cutoff early
+  float staticScore;
+  // line rewards of both moves
+  float base;
+  // no third piece can reach more than this
+  float bound;
+  float values[PIECE_COUNT];
+  // bit N is set once values[N] is in
+  uint8_t doneBranches;
+  bool isPruned;
+  float value;
+} BotChanceNode;
+
+typedef struct {
+  long decisions;
+  double totalSeconds;
+  double lastSeconds;
+  long transpositionProbes;
+  long transpositionHits;
+  // boards evaluated
+  long nodes;
+  long chanceNodes;
+  // third piece branches skipped because their chance node could no longer win
+  long prunedBranches;
+  // moves by the number of pieces their search placed
+  long depthCounts[BOT_MAX_DEPTH + 1];
+} BotStats;
+
+typedef struct {
+  // pieces placed by the deepest finished iteration, 2 for the beam search and 3 for BOT_SEARCH_EXPECTIMAX
+  int depth;
+  long nodes;
+  double seconds;
+} BotMoveStats;
+
+// Drives SimStep towards a chosen placement one button press at a time, separate from the search so the two can run on different threads
+typedef struct {
+  bool hasTarget;
+  bool isPathValid;
+  Placement target;
+  int pathLength;
+  int pathIndex;
+  uint8_t path[BOT_MAX_PATH_LENGTH];
+  Piece pathPieces[BOT_MAX_PATH_LENGTH + 1];
+  int16_t parents[4][16][ROWS];
+  uint8_t parentMoves[4][16][ROWS];
+  int16_t queue[4 * 16 * ROWS];
+} BotController;
+
+typedef struct {
+  BotConfig config;
+  // change them with BotSetWeights, the transposition table holds scores computed under them
+  EvalWeights weights;
+  Pool *pool;
+  int beamWidth;
+  int nextType;
+  int candidateCount;
+  BotCandidate candidates[MOVEGEN_MAX_PLACEMENTS];
+  EvalPath evalPath;
+  TranspositionTable *transpositions;
+  // expectimax, chanceNodes[I * BOT_EXPECTIMAX_WIDTH] onwards belong to candidate I until they are sorted best first
+  int chanceNodeCounts[BOT_MAX_BEAM_WIDTH];
+  int chanceNodeCount;
+  BotChanceNode chanceNodes[BOT_MAX_BEAM_WIDTH * BOT_EXPECTIMAX_WIDTH];
+  int branchTypes[PIECE_COUNT];
+  float branchWeights[PIECE_COUNT];
+  // pieces each branch places
+  int branchDepth;
+  // value of the best chance node searched so far
+  float alpha;
+  // CLOCK_MONOTONIC seconds BotDecideAhead has to answer by, 0 for no limit, the iteration running past it is dropped
+  double deadline;
+  bool isAborted;
+  // scratch for each pool worker
+  BotWorker *workers;
+  BotStats stats;
+  BotMoveStats lastMove;
+  // pieces seen by BotGetInput, a new one means a new decision
+  int pieceCount;
+  BotController controller;
+} Bot;
+
+Bot *BotCreate(const BotConfig *config);
+void BotDestroy(Bot *bot);
+void BotReset(Bot *bot);
+void BotSetWeights(Bot *bot, const EvalWeights *weights);
+bool BotDecide(Bot *bot, const SimState *state, Placement *placement);
+bool BotDecideAhead(Bot *bot, const SimState *state, double deadline, Placement *placement);
+uint8_t BotGetInput(Bot *bot, const SimState *state);
+void BotControllerSetTarget(BotController *controller, const Placement *target);
+uint8_t BotControllerGetInput(BotController *controller, const SimState *state);
+int BotGetPieceCount(const SimState *state);
+
+extern const BotConfig botDefaultConfig;
+
+#endif // BOT_H
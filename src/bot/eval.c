@@ -0,0 +1,188 @@
+#include "eval.h"
+
+#define PLAYFIELD_CELLS ((uint16_t)~BOARD_EMPTY_ROW)
+// bit X of (row ^ row >> 1) is a change between bits X and X + 1, these cover the left wall to the right wall
+#define TRANSITION_BITS (((1 << (COLUMNS + 1)) - 1) << (BOARD_WALL_WIDTH - 1))
+// bit X of (covered ^ covered >> 1) compares column X with X + 1, these cover the playfield columns that have a right neighbour
+#define NEIGHBOR_BITS (((1 << (COLUMNS - 1)) - 1) << BOARD_WALL_WIDTH)
+
+const EvalWeights evalDefaultWeights = {
+    .aggregateHeight = -0.51f,
+    .holes = -0.36f,
+    .bumpiness = -0.18f,
+    .wells = -0.05f,
+    .rowTransitions = -0.1f,
+    .lineClears = {0.76f, 1.52f, 2.28f, 3.04f},
+};
+
+// Everything comes from one top-down pass over the row bitboards, `covered` holds the columns that have a block above the current row
+void EvalGetFeatures(const Board *board, EvalFeatures *features) {
+  int heights[COLUMNS + 2];
+  uint16_t covered = 0;
+  *features = (EvalFeatures){0};
+  for (int x = 0; x < COLUMNS; x++) {
+    heights[x + 1] = 0;
+  }
+  for (int y = 0; y < ROWS; y++) {
+    const uint16_t row = board->rows[y];
+    const uint16_t cells = row & PLAYFIELD_CELLS;
+    uint16_t tops = cells & ~covered;
+    while (tops) {
+      heights[__builtin_ctz(tops) - BOARD_WALL_WIDTH + 1] = ROWS - y;
+      tops &= tops - 1;
+    }
+    features->holes += __builtin_popcount(covered & ~cells);
+    features->rowTransitions += __builtin_popcount((row ^ (row >> 1)) & TRANSITION_BITS);
+    covered |= cells;
+  }
+
+  // the walls count as full height so a column against them can still be a well
+  heights[0] = ROWS;
+  heights[COLUMNS + 1] = ROWS;
+  for (int x = 1; x <= COLUMNS; x++) {
+    const int lowestNeighbor = heights[x - 1] < heights[x + 1] ? heights[x - 1] : heights[x + 1];
+    features->aggregateHeight += heights[x];
+    features->wells += lowestNeighbor > heights[x] ? lowestNeighbor - heights[x] : 0;
+    if (x < COLUMNS) {
+      features->bumpiness += heights[x] > heights[x + 1] ? heights[x] - heights[x + 1] : heights[x + 1] - heights[x];
+    }
+  }
+}
+
+float EvalBoard(const Board *board, int linesCleared, const EvalWeights *weights) {
+  EvalFeatures features;
+  EvalGetFeatures(board, &features);
+  const float score = weights->aggregateHeight * features.aggregateHeight + weights->holes * features.holes +
+                      weights->bumpiness * features.bumpiness + weights->wells * features.wells +
+                      weights->rowTransitions * features.rowTransitions;
+  return linesCleared > 0 ? score + weights->lineClears[linesCleared - 1] : score;
+}
+
+void EvalBatchSetBoard(EvalBatch *batch, int index, const Board *board, int linesCleared) {
+  for (int y = 0; y < ROWS; y++) {
+    batch->rows[y][index] = board->rows[y];
+  }
+  batch->linesCleared[index] = linesCleared;
+}
+
+// The widest path this CPU can run, checked at runtime so one binary works everywhere
+EvalPath EvalGetBestPath(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return EVAL_PATH_AVX2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return EVAL_PATH_SSE2;
+  }
+#endif
+  return EVAL_PATH_SCALAR;
+}
+
+// The batched paths get every feature from per-row bit operations, summed over the rows with a popcount.
+// `covered` includes the walls, so a column next to one can be a well like in EvalGetFeatures:
+//   aggregate height: covered columns, a column of height H is covered on H rows
+//   holes:            covered but empty cells
+//   bumpiness:        neighbouring columns where only one is covered, |H(x) - H(x + 1)| rows each
+//   wells:            uncovered columns with both neighbours covered
+//   row transitions:  filled to empty changes along the row, walls included
+static void EvalBatchFeaturesScalar(const EvalBatch *batch, int index, EvalFeatures *features) {
+  uint32_t covered = BOARD_EMPTY_ROW;
+  *features = (EvalFeatures){0};
+  for (int y = 0; y < ROWS; y++) {
+    const uint32_t row = batch->rows[y][index];
+    features->holes += __builtin_popcount(covered & ~row & PLAYFIELD_CELLS);
+    features->rowTransitions += __builtin_popcount((row ^ (row >> 1)) & TRANSITION_BITS);
+    covered |= row;
+    features->aggregateHeight += __builtin_popcount(covered & PLAYFIELD_CELLS);
+    features->bumpiness += __builtin_popcount((covered ^ (covered >> 1)) & NEIGHBOR_BITS);
+    features->wells += __builtin_popcount(~covered & (covered << 1) & (covered >> 1) & PLAYFIELD_CELLS);
+  }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+// SWAR popcount of every 16-bit lane
+#define POPCOUNT16(PREFIX, SUFFIX, X)                                                                                                      \
+  do {                                                                                                                                     \
+    X = PREFIX##_sub_epi16(X, PREFIX##_and_##SUFFIX(PREFIX##_srli_epi16(X, 1), PREFIX##_set1_epi16(0x5555)));                              \
+    X = PREFIX##_add_epi16(PREFIX##_and_##SUFFIX(X, PREFIX##_set1_epi16(0x3333)),                                                          \
+                           PREFIX##_and_##SUFFIX(PREFIX##_srli_epi16(X, 2), PREFIX##_set1_epi16(0x3333)));                                 \
+    X = PREFIX##_and_##SUFFIX(PREFIX##_add_epi16(X, PREFIX##_srli_epi16(X, 4)), PREFIX##_set1_epi16(0x0F0F));                              \
+    X = PREFIX##_srli_epi16(PREFIX##_add_epi16(X, PREFIX##_slli_epi16(X, 8)), 8);                                                          \
+  } while (0)
+
+// One body for both vector widths, PREFIX/SUFFIX pick _mm/si128 or _mm256/si256
+#define EVAL_BATCH_FEATURES(VECTOR, PREFIX, SUFFIX, LANES)                                                                                 \
+  for (int i = 0; i < batch->count; i += LANES) {                                                                                          \
+    const VECTOR playfield = PREFIX##_set1_epi16(PLAYFIELD_CELLS);                                                                         \
+    const VECTOR transitionBits = PREFIX##_set1_epi16(TRANSITION_BITS);                                                                    \
+    const VECTOR neighborBits = PREFIX##_set1_epi16(NEIGHBOR_BITS);                                                                        \
+    VECTOR covered = PREFIX##_set1_epi16((int16_t)BOARD_EMPTY_ROW);                                                                        \
+    VECTOR sums[5] = {PREFIX##_setzero_##SUFFIX(), PREFIX##_setzero_##SUFFIX(), PREFIX##_setzero_##SUFFIX(), PREFIX##_setzero_##SUFFIX(),  \
+                      PREFIX##_setzero_##SUFFIX()};                                                                                        \
+    for (int y = 0; y < ROWS; y++) {                                                                                                       \
+      const VECTOR row = PREFIX##_loadu_##SUFFIX((const VECTOR *)&batch->rows[y][i]);                                                      \
+      VECTOR counts[5];                                                                                                                    \
+      counts[0] = PREFIX##_and_##SUFFIX(PREFIX##_andnot_##SUFFIX(row, covered), playfield);                                                \
+      counts[1] = PREFIX##_and_##SUFFIX(PREFIX##_xor_##SUFFIX(row, PREFIX##_srli_epi16(row, 1)), transitionBits);                          \
+      covered = PREFIX##_or_##SUFFIX(covered, row);                                                                                        \
+      counts[2] = PREFIX##_and_##SUFFIX(covered, playfield);                                                                               \
+      counts[3] = PREFIX##_and_##SUFFIX(PREFIX##_xor_##SUFFIX(covered, PREFIX##_srli_epi16(covered, 1)), neighborBits);                    \
+      counts[4] = PREFIX##_and_##SUFFIX(                                                                                                   \
+          PREFIX##_andnot_##SUFFIX(covered, PREFIX##_and_##SUFFIX(PREFIX##_slli_epi16(covered, 1), PREFIX##_srli_epi16(covered, 1))),      \
+          playfield);                                                                                                                      \
+      for (int feature = 0; feature < 5; feature++) {                                                                                      \
+        POPCOUNT16(PREFIX, SUFFIX, counts[feature]);                                                                                       \
+        sums[feature] = PREFIX##_add_epi16(sums[feature], counts[feature]);                                                                \
+      }                                                                                                                                    \
+    }                                                                                                                                      \
+    uint16_t lanes[5][LANES];                                                                                                              \
+    for (int feature = 0; feature < 5; feature++) {                                                                                        \
+      PREFIX##_storeu_##SUFFIX((VECTOR *)lanes[feature], sums[feature]);                                                                   \
+    }                                                                                                                                      \
+    for (int lane = 0; lane < LANES && i + lane < batch->count; lane++) {                                                                  \
+      features[i + lane] = (EvalFeatures){lanes[2][lane], lanes[0][lane], lanes[3][lane], lanes[4][lane], lanes[1][lane]};                 \
+    }                                                                                                                                      \
+  }
+
+static void EvalBatchFeaturesSse2(const EvalBatch *batch, EvalFeatures *features) { EVAL_BATCH_FEATURES(__m128i, _mm, si128, 8) }
+
+__attribute__((target("avx2"))) static void EvalBatchFeaturesAvx2(const EvalBatch *batch, EvalFeatures *features) {
+  EVAL_BATCH_FEATURES(__m256i, _mm256, si256, 16)
+}
+#endif
+
+void EvalBatchGetFeatures(const EvalBatch *batch, EvalPath path, EvalFeatures *features) {
+  switch (path) {
+#if defined(__x86_64__) || defined(__i386__)
+  case EVAL_PATH_AVX2:
+    EvalBatchFeaturesAvx2(batch, features);
+    return;
+  case EVAL_PATH_SSE2:
+    EvalBatchFeaturesSse2(batch, features);
+    return;
+#else
+  case EVAL_PATH_AVX2:
+  case EVAL_PATH_SSE2:
+#endif
+  case EVAL_PATH_SCALAR:
+    for (int i = 0; i < batch->count; i++) {
+      EvalBatchFeaturesScalar(batch, i, &features[i]);
+    }
+    return;
+  }
+}
+
+// Same sums as EvalBoard, scores[I] is the score of board I
+void EvalBatchScore(const EvalBatch *batch, const EvalWeights *weights, EvalPath path, float *scores) {
+  EvalFeatures features[EVAL_BATCH_SIZE];
+  EvalBatchGetFeatures(batch, path, features);
+  for (int i = 0; i < batch->count; i++) {
+    const float score = weights->aggregateHeight * features[i].aggregateHeight + weights->holes * features[i].holes +
+                        weights->bumpiness * features[i].bumpiness + weights->wells * features[i].wells +
+                        weights->rowTransitions * features[i].rowTransitions;
+    scores[i] = batch->linesCleared[i] > 0 ? score + weights->lineClears[batch->linesCleared[i] - 1] : score;
+  }
+}
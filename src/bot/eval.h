@@ -0,0 +1,50 @@
+#ifndef EVAL_H
+#define EVAL_H
+
+#include "../core/board.h"
+
+// boards scored together by EvalBatchScore, a multiple of the widest vector (16 lanes of uint16 for AVX2)
+#define EVAL_BATCH_SIZE 64
+
+typedef struct {
+  int aggregateHeight;
+  int holes;
+  int bumpiness;
+  int wells;
+  int rowTransitions;
+} EvalFeatures;
+
+// Linear weights over EvalFeatures, lineClears[N - 1] rewards clearing N lines with the move that made the board
+typedef struct {
+  float aggregateHeight;
+  float holes;
+  float bumpiness;
+  float wells;
+  float rowTransitions;
+  float lineClears[4];
+} EvalWeights;
+
+typedef enum {
+  EVAL_PATH_SCALAR,
+  EVAL_PATH_SSE2,
+  EVAL_PATH_AVX2,
+} EvalPath;
+
+// Structure of arrays, rows[Y][I] is row Y of board I so one vector load picks up the same row of neighbouring boards.
+// Only the occupancy is kept, the features don't need shape types.
+typedef struct {
+  uint16_t rows[ROWS][EVAL_BATCH_SIZE];
+  uint8_t linesCleared[EVAL_BATCH_SIZE];
+  int count;
+} EvalBatch;
+
+void EvalGetFeatures(const Board *board, EvalFeatures *features);
+float EvalBoard(const Board *board, int linesCleared, const EvalWeights *weights);
+void EvalBatchSetBoard(EvalBatch *batch, int index, const Board *board, int linesCleared);
+void EvalBatchGetFeatures(const EvalBatch *batch, EvalPath path, EvalFeatures *features);
+void EvalBatchScore(const EvalBatch *batch, const EvalWeights *weights, EvalPath path, float *scores);
+EvalPath EvalGetBestPath(void);
+
+extern const EvalWeights evalDefaultWeights;
+
+#endif // EVAL_H
@@ -0,0 +1,158 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pool.h"
+
+#define POOL_MAX_THREADS 64
+// how long an idle worker polls for the next run before sleeping, decisions come back to back while searching
+#define POOL_SPIN_COUNT 20000
+#define POOL_CACHE_LINE 64
+
+#if defined(__x86_64__) || defined(__i386__)
+#define POOL_PAUSE() __builtin_ia32_pause()
+#else
+#define POOL_PAUSE() ((void)0)
+#endif
+
+// Each worker owns a slice of the indices and claims from its front, once it is drained the worker steals from the other slices.
+// Claims are a single fetch-add on the slice, so owners and thieves never need a lock.
+typedef struct {
+  __attribute__((aligned(POOL_CACHE_LINE))) int next;
+  int end;
+} PoolRange;
+
+typedef struct {
+  Pool *pool;
+  int worker;
+} PoolWorker;
+
+struct Pool {
+  PoolRange ranges[POOL_MAX_THREADS];
+  PoolWorker workers[POOL_MAX_THREADS];
+  pthread_t threads[POOL_MAX_THREADS];
+  int threadCount;
+  PoolTask task;
+  void *context;
+  pthread_mutex_t mutex;
+  pthread_cond_t wake;
+  // bumped once per PoolRun, workers wake up when it changes
+  __attribute__((aligned(POOL_CACHE_LINE))) unsigned generation;
+  // workers still inside the current run, the caller can't hand out the next run until it reaches 0
+  __attribute__((aligned(POOL_CACHE_LINE))) int activeWorkers;
+  bool isStopping;
+};
+
+static void *PoolWorkerMain(void *arg);
+static void PoolWork(Pool *pool, int worker);
+
+// threadCount includes the calling thread, 1 or less runs every task on the caller.
+// If threads can't be started (e.g. a web build without pthreads) the pool keeps the ones it got.
+Pool *PoolCreate(int threadCount) {
+  Pool *pool = NULL;
+  if (posix_memalign((void **)&pool, POOL_CACHE_LINE, sizeof(Pool)) != 0) {
+    return NULL;
+  }
+  memset(pool, 0, sizeof(Pool));
+  pthread_mutex_init(&pool->mutex, NULL);
+  pthread_cond_init(&pool->wake, NULL);
+  pool->threadCount = 1;
+  threadCount = threadCount < 1 ? 1 : threadCount > POOL_MAX_THREADS ? POOL_MAX_THREADS : threadCount;
+  for (int i = 1; i < threadCount; i++) {
+    pool->workers[i] = (PoolWorker){pool, i};
+    if (pthread_create(&pool->threads[i], NULL, PoolWorkerMain, &pool->workers[i]) != 0) {
+      break;
+    }
+    pool->threadCount++;
+  }
+  return pool;
+}
+
+void PoolDestroy(Pool *pool) {
+  if (!pool) {
+    return;
+  }
+  pthread_mutex_lock(&pool->mutex);
+  __atomic_store_n(&pool->isStopping, true, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&pool->generation, 1, __ATOMIC_RELEASE);
+  pthread_cond_broadcast(&pool->wake);
+  pthread_mutex_unlock(&pool->mutex);
+  for (int i = 1; i < pool->threadCount; i++) {
+    pthread_join(pool->threads[i], NULL);
+  }
+  pthread_cond_destroy(&pool->wake);
+  pthread_mutex_destroy(&pool->mutex);
+  free(pool);
+}
+
+int PoolThreadCount(const Pool *pool) { return pool ? pool->threadCount : 1; }
+
+// A NULL pool runs everything on the caller as worker 0
+void PoolRun(Pool *pool, int count, PoolTask task, void *context) {
+  if (!pool || pool->threadCount == 1 || count <= 1) {
+    for (int i = 0; i < count; i++) {
+      task(context, i, 0);
+    }
+    return;
+  }
+
+  const int threadCount = pool->threadCount;
+  for (int i = 0; i < threadCount; i++) {
+    pool->ranges[i].next = (int)((long)count * i / threadCount);
+    pool->ranges[i].end = (int)((long)count * (i + 1) / threadCount);
+  }
+  pool->task = task;
+  pool->context = context;
+  __atomic_store_n(&pool->activeWorkers, threadCount - 1, __ATOMIC_RELAXED);
+
+  pthread_mutex_lock(&pool->mutex);
+  __atomic_add_fetch(&pool->generation, 1, __ATOMIC_RELEASE);
+  pthread_cond_broadcast(&pool->wake);
+  pthread_mutex_unlock(&pool->mutex);
+
+  PoolWork(pool, 0);
+  while (__atomic_load_n(&pool->activeWorkers, __ATOMIC_ACQUIRE) != 0) {
+    POOL_PAUSE();
+  }
+}
+
+static void PoolWork(Pool *pool, int worker) {
+  const int threadCount = pool->threadCount;
+  for (int i = 0; i < threadCount; i++) {
+    PoolRange *range = &pool->ranges[(worker + i) % threadCount];
+    while (__atomic_load_n(&range->next, __ATOMIC_RELAXED) < range->end) {
+      const int index = __atomic_fetch_add(&range->next, 1, __ATOMIC_RELAXED);
+      if (index >= range->end) {
+        break;
+      }
+      pool->task(pool->context, index, worker);
+    }
+  }
+}
+
+static void *PoolWorkerMain(void *arg) {
+  const PoolWorker *self = arg;
+  Pool *pool = self->pool;
+  unsigned seen = 0;
+  for (;;) {
+    unsigned generation = __atomic_load_n(&pool->generation, __ATOMIC_ACQUIRE);
+    for (int spin = 0; generation == seen && spin < POOL_SPIN_COUNT; spin++) {
+      POOL_PAUSE();
+      generation = __atomic_load_n(&pool->generation, __ATOMIC_ACQUIRE);
+    }
+    if (generation == seen) {
+      pthread_mutex_lock(&pool->mutex);
+      while ((generation = __atomic_load_n(&pool->generation, __ATOMIC_ACQUIRE)) == seen) {
+        pthread_cond_wait(&pool->wake, &pool->mutex);
+      }
+      pthread_mutex_unlock(&pool->mutex);
+    }
+    seen = generation;
+    if (__atomic_load_n(&pool->isStopping, __ATOMIC_RELAXED)) {
+      return NULL;
+    }
+    PoolWork(pool, self->worker);
+    __atomic_sub_fetch(&pool->activeWorkers, 1, __ATOMIC_RELEASE);
+  }
+}
@@ -0,0 +1,15 @@
+#ifndef POOL_H
+#define POOL_H
+
+// Runs task(context, index, worker) for every index in [0, count), worker is in [0, PoolThreadCount) and
+// identifies the thread, so tasks can use per-worker scratch memory without locking
+typedef void (*PoolTask)(void *context, int index, int worker);
+
+typedef struct Pool Pool;
+
+Pool *PoolCreate(int threadCount);
+void PoolDestroy(Pool *pool);
+int PoolThreadCount(const Pool *pool);
+void PoolRun(Pool *pool, int count, PoolTask task, void *context);
+
+#endif // POOL_H
@@ -0,0 +1,71 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ring.h"
+
+#define RING_CACHE_LINE 64
+
+// head and tail only ever grow, the slot is the count modulo the capacity.
+// Each side keeps its own counter on its own cache line so the producer and the consumer don't keep stealing it from each other.
+struct Ring {
+  __attribute__((aligned(RING_CACHE_LINE))) uint32_t head;
+  __attribute__((aligned(RING_CACHE_LINE))) uint32_t tail;
+  __attribute__((aligned(RING_CACHE_LINE))) uint32_t mask;
+  size_t elementSize;
+  unsigned char *slots;
+};
+
+// capacity is rounded up to a power of two
+Ring *RingCreate(int capacity, size_t elementSize) {
+  Ring *ring = NULL;
+  if (posix_memalign((void **)&ring, RING_CACHE_LINE, sizeof(Ring)) != 0) {
+    return NULL;
+  }
+  memset(ring, 0, sizeof(Ring));
+  uint32_t slotCount = 1;
+  while ((int)slotCount < capacity) {
+    slotCount *= 2;
+  }
+  ring->mask = slotCount - 1;
+  ring->elementSize = elementSize;
+  ring->slots = malloc(slotCount * elementSize);
+  if (!ring->slots) {
+    free(ring);
+    return NULL;
+  }
+  return ring;
+}
+
+void RingDestroy(Ring *ring) {
+  if (!ring) {
+    return;
+  }
+  free(ring->slots);
+  free(ring);
+}
+
+// Producer only, false when the ring is full
+bool RingPush(Ring *ring, const void *element) {
+  const uint32_t tail = ring->tail;
+  if (tail - __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) > ring->mask) {
+    return false;
+  }
+  memcpy(ring->slots + (tail & ring->mask) * ring->elementSize, element, ring->elementSize);
+  __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+// Consumer only, false when the ring is empty
+bool RingPop(Ring *ring, void *element) {
+  const uint32_t head = ring->head;
+  if (head == __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) {
+    return false;
+  }
+  memcpy(element, ring->slots + (head & ring->mask) * ring->elementSize, ring->elementSize);
+  __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+// Consumer only
+bool RingIsEmpty(const Ring *ring) { return ring->head == __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE); }
@@ -0,0 +1,17 @@
+#ifndef RING_H
+#define RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Fixed size single producer, single consumer queue of equally sized elements.
+// One thread pushes and one thread pops, neither ever waits on the other.
+typedef struct Ring Ring;
+
+Ring *RingCreate(int capacity, size_t elementSize);
+void RingDestroy(Ring *ring);
+bool RingPush(Ring *ring, const void *element);
+bool RingPop(Ring *ring, void *element);
+bool RingIsEmpty(const Ring *ring);
+
+#endif // RING_H
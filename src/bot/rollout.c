@@ -0,0 +1,117 @@
+#include <stdlib.h>
+
+#include "../core/util.h"
+#include "rollout.h"
+
+static void RolloutPlay(void *context, int index, int worker);
+static int RolloutChoosePlacement(RolloutEvaluator *evaluator, RolloutWorker *scratch, const Board *board, int type);
+
+// The pool isn't owned, it can be shared with a Bot. NULL runs the rollouts on the caller.
+RolloutEvaluator *RolloutCreate(Pool *pool) {
+  RolloutEvaluator *evaluator = calloc(1, sizeof(RolloutEvaluator));
+  if (!evaluator) {
+    return NULL;
+  }
+  evaluator->pool = pool;
+  evaluator->evalPath = EvalGetBestPath();
+  evaluator->workers = malloc(PoolThreadCount(pool) * sizeof(RolloutWorker));
+  if (!evaluator->workers) {
+    free(evaluator);
+    return NULL;
+  }
+  return evaluator;
+}
+
+void RolloutDestroy(RolloutEvaluator *evaluator) {
+  if (!evaluator) {
+    return;
+  }
+  free(evaluator->workers);
+  free(evaluator);
+}
+
+// Plays config->rolloutCount random continuations of start in parallel, placement by placement rather than frame by frame
+void RolloutRun(RolloutEvaluator *evaluator, const SimState *start, const RolloutConfig *config, RolloutResult *result) {
+  evaluator->config = *config;
+  evaluator->weights = config->weights ? *config->weights : evalDefaultWeights;
+  evaluator->start = start;
+  evaluator->result = (RolloutResult){0};
+  PoolRun(evaluator->pool, config->rolloutCount, RolloutPlay, evaluator);
+  *result = evaluator->result;
+}
+
+static void RolloutPlay(void *context, int index, int worker) {
+  RolloutEvaluator *evaluator = context;
+  RolloutWorker *scratch = &evaluator->workers[worker];
+  const SimState *start = evaluator->start;
+  RngSeed(&scratch->pieceRng, RngStreamSeed(evaluator->config.seed, 2 * (uint64_t)index));
+  RngSeed(&scratch->choiceRng, RngStreamSeed(evaluator->config.seed, 2 * (uint64_t)index + 1));
+
+  Board board = start->board;
+  Piece piece = start->currentPiece;
+  int nextType = start->nextPiece.type;
+  int linesCleared = start->linesCleared;
+  RolloutResult result = {.rollouts = 1};
+  for (int i = 0; i < evaluator->config.pieceLimit; i++) {
+    if (!PieceFits(&board, piece.type, piece.rotationIndex, piece.x, piece.y)) {
+      result.topOuts++;
+      break;
+    }
+    MovegenPlacements(&board, &piece, &scratch->list);
+    const int choice = RolloutChoosePlacement(evaluator, scratch, &board, piece.type);
+    if (choice < 0) {
+      result.topOuts++;
+      break;
+    }
+    const int cleared = MovegenApplyPlacement(&board, piece.type, &scratch->list.placements[choice]);
+    result.pieces++;
+    if (cleared > 0) {
+      linesCleared += cleared;
+      result.linesCleared += cleared;
+      result.tetrises += cleared == 4;
+      result.score += SimGetLineClearScore(cleared, SimGetLevel(start->startingLevel, linesCleared));
+    }
+    const Piece generated = PieceGetRandom(&scratch->pieceRng, nextType);
+    piece = (Piece){nextType, INITIAL_BOARD_X, INITIAL_BOARD_Y, INITIAL_ROTATION};
+    nextType = generated.type;
+  }
+
+  // plain atomic adds, no lock is held while rollouts run
+  __atomic_fetch_add(&evaluator->result.rollouts, result.rollouts, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&evaluator->result.pieces, result.pieces, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&evaluator->result.linesCleared, result.linesCleared, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&evaluator->result.tetrises, result.tetrises, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&evaluator->result.topOuts, result.topOuts, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&evaluator->result.score, result.score, __ATOMIC_RELAXED);
+}
+
+// Index into scratch->list, a random one or the best scoring, -1 when there are no placements
+static int RolloutChoosePlacement(RolloutEvaluator *evaluator, RolloutWorker *scratch, const Board *board, int type) {
+  const PlacementList *list = &scratch->list;
+  if (list->count == 0) {
+    return -1;
+  }
+  const float roll = RngNext(&scratch->choiceRng) / 4294967296.0f;
+  if (roll < evaluator->config.randomness) {
+    return RngRange(&scratch->choiceRng, 0, list->count - 1);
+  }
+
+  int best = 0;
+  float bestScore = 0.0f;
+  for (int start = 0; start < list->count; start += EVAL_BATCH_SIZE) {
+    scratch->batch.count = MIN(EVAL_BATCH_SIZE, list->count - start);
+    for (int i = 0; i < scratch->batch.count; i++) {
+      Board child = *board;
+      const int linesCleared = MovegenApplyPlacement(&child, type, &list->placements[start + i]);
+      EvalBatchSetBoard(&scratch->batch, i, &child, linesCleared);
+    }
+    EvalBatchScore(&scratch->batch, &evaluator->weights, evaluator->evalPath, scratch->scores);
+    for (int i = 0; i < scratch->batch.count; i++) {
+      if ((start == 0 && i == 0) || scratch->scores[i] > bestScore) {
+        best = start + i;
+        bestScore = scratch->scores[i];
+      }
+    }
+  }
+  return best;
+}
@@ -0,0 +1,56 @@
+#ifndef ROLLOUT_H
+#define ROLLOUT_H
+
+#include <stdint.h>
+
+#include "../core/movegen.h"
+#include "../core/sim.h"
+#include "eval.h"
+#include "pool.h"
+
+typedef struct {
+  int rolloutCount;
+  // pieces placed per rollout, the current piece included
+  int pieceLimit;
+  // chance of placing a piece at a uniformly random placement instead of the best one by the weights
+  float randomness;
+  // rollout N always sees the same pieces and random choices for a given seed, however many threads run them
+  uint64_t seed;
+  // NULL for evalDefaultWeights
+  const EvalWeights *weights;
+} RolloutConfig;
+
+// Totals over every rollout, score follows SimStep's scoring and level progression
+typedef struct {
+  long rollouts;
+  long pieces;
+  long linesCleared;
+  long tetrises;
+  long topOuts;
+  long score;
+} RolloutResult;
+
+typedef struct {
+  PlacementList list;
+  EvalBatch batch;
+  float scores[EVAL_BATCH_SIZE];
+  // reseeded at the start of every rollout
+  Rng pieceRng;
+  Rng choiceRng;
+} RolloutWorker;
+
+typedef struct {
+  Pool *pool;
+  RolloutWorker *workers;
+  EvalPath evalPath;
+  EvalWeights weights;
+  RolloutConfig config;
+  const SimState *start;
+  RolloutResult result;
+} RolloutEvaluator;
+
+RolloutEvaluator *RolloutCreate(Pool *pool);
+void RolloutDestroy(RolloutEvaluator *evaluator);
+void RolloutRun(RolloutEvaluator *evaluator, const SimState *start, const RolloutConfig *config, RolloutResult *result);
+
+#endif // ROLLOUT_H
@@ -0,0 +1,113 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "transposition.h"
+
+#define TRANSPOSITION_CACHE_LINE 64
+#define TRANSPOSITION_BUCKET_SIZE 4
+// data is score bits 0-31, depth bits 32-39 and generation bits 40-47
+#define TRANSPOSITION_DATA(SCORE_BITS, DEPTH, GENERATION) ((uint64_t)(SCORE_BITS) | (uint64_t)(DEPTH) << 32 | (uint64_t)(GENERATION) << 40)
+#define TRANSPOSITION_DEPTH(DATA) ((int)((DATA) >> 32 & 0xFF))
+#define TRANSPOSITION_GENERATION(DATA) ((uint8_t)((DATA) >> 40))
+
+typedef struct {
+  uint64_t check;
+  uint64_t data;
+} TranspositionEntry;
+
+// a bucket fills one cache line, so a probe touches a single line
+typedef struct {
+  __attribute__((aligned(TRANSPOSITION_CACHE_LINE))) TranspositionEntry entries[TRANSPOSITION_BUCKET_SIZE];
+} TranspositionBucket;
+
+struct TranspositionTable {
+  TranspositionBucket *buckets;
+  uint64_t bucketMask;
+  uint8_t generation;
+};
+
+static uint64_t TranspositionKey(uint64_t key, int depth);
+
+// bytes is the memory budget, rounded down to a power of two buckets
+TranspositionTable *TranspositionCreate(size_t bytes) {
+  TranspositionTable *table = calloc(1, sizeof(TranspositionTable));
+  if (!table) {
+    return NULL;
+  }
+  size_t bucketCount = 1;
+  while (bucketCount * 2 * sizeof(TranspositionBucket) <= bytes) {
+    bucketCount *= 2;
+  }
+  if (posix_memalign((void **)&table->buckets, TRANSPOSITION_CACHE_LINE, bucketCount * sizeof(TranspositionBucket)) != 0) {
+    free(table);
+    return NULL;
+  }
+  table->bucketMask = bucketCount - 1;
+  TranspositionClear(table);
+  return table;
+}
+
+void TranspositionDestroy(TranspositionTable *table) {
+  if (!table) {
+    return;
+  }
+  free(table->buckets);
+  free(table);
+}
+
+// not thread safe, only call it while no search is running
+void TranspositionClear(TranspositionTable *table) {
+  memset(table->buckets, 0, (table->bucketMask + 1) * sizeof(TranspositionBucket));
+  table->generation = 0;
+}
+
+size_t TranspositionEntryCount(const TranspositionTable *table) { return (table->bucketMask + 1) * TRANSPOSITION_BUCKET_SIZE; }
+
+// Entries stored before the last few generations are the first to go, call it between searches
+void TranspositionNextGeneration(TranspositionTable *table) { table->generation++; }
+
+bool TranspositionProbe(const TranspositionTable *table, uint64_t key, int depth, float *score) {
+  key = TranspositionKey(key, depth);
+  const TranspositionEntry *entries = table->buckets[key & table->bucketMask].entries;
+  for (int i = 0; i < TRANSPOSITION_BUCKET_SIZE; i++) {
+    const uint64_t data = __atomic_load_n(&entries[i].data, __ATOMIC_RELAXED);
+    const uint64_t check = __atomic_load_n(&entries[i].check, __ATOMIC_RELAXED);
+    if ((check ^ data) == key && TRANSPOSITION_DEPTH(data) == depth) {
+      const uint32_t scoreBits = (uint32_t)data;
+      memcpy(score, &scoreBits, sizeof(float));
+      return true;
+    }
+  }
+  return false;
+}
+
+// Takes the slot already holding the key, otherwise the one that is least worth keeping: empty, then old, then shallow
+void TranspositionStore(TranspositionTable *table, uint64_t key, int depth, float score) {
+  key = TranspositionKey(key, depth);
+  TranspositionEntry *entries = table->buckets[key & table->bucketMask].entries;
+  const uint8_t generation = table->generation;
+  int victim = 0;
+  int victimWorth = 0x7FFFFFFF;
+  for (int i = 0; i < TRANSPOSITION_BUCKET_SIZE; i++) {
+    const uint64_t data = __atomic_load_n(&entries[i].data, __ATOMIC_RELAXED);
+    const uint64_t check = __atomic_load_n(&entries[i].check, __ATOMIC_RELAXED);
+    if ((check ^ data) == key) {
+      victim = i;
+      break;
+    }
+    const int age = (uint8_t)(generation - TRANSPOSITION_GENERATION(data));
+    const int worth = (check | data) == 0 ? -1 : TRANSPOSITION_DEPTH(data) * 4 - age;
+    if (worth < victimWorth) {
+      victim = i;
+      victimWorth = worth;
+    }
+  }
+  uint32_t scoreBits;
+  memcpy(&scoreBits, &score, sizeof(float));
+  const uint64_t data = TRANSPOSITION_DATA(scoreBits, depth, generation);
+  __atomic_store_n(&entries[victim].data, data, __ATOMIC_RELAXED);
+  __atomic_store_n(&entries[victim].check, key ^ data, __ATOMIC_RELAXED);
+}
+
+// the same board searched to another depth is another entry, it also keeps a zero key off the empty slot pattern
+static uint64_t TranspositionKey(uint64_t key, int depth) { return key ^ ((uint64_t)(depth + 1) * 0x9E3779B97F4A7C15ull); }
@@ -0,0 +1,20 @@
+#ifndef TRANSPOSITION_H
+#define TRANSPOSITION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Fixed size table of search results shared by every search thread without locks.
+// Each entry stores key ^ data next to data, a torn write from two threads racing on a slot fails that check and reads as a miss.
+typedef struct TranspositionTable TranspositionTable;
+
+TranspositionTable *TranspositionCreate(size_t bytes);
+void TranspositionDestroy(TranspositionTable *table);
+void TranspositionClear(TranspositionTable *table);
+size_t TranspositionEntryCount(const TranspositionTable *table);
+void TranspositionNextGeneration(TranspositionTable *table);
+bool TranspositionProbe(const TranspositionTable *table, uint64_t key, int depth, float *score);
+void TranspositionStore(TranspositionTable *table, uint64_t key, int depth, float score);
+
+#endif // TRANSPOSITION_H
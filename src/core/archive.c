@@ -0,0 +1,165 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "archive.h"
+#include "replay.h"
+#include "util.h"
+
+struct Archive {
+  int fd;
+  bool isAppending;
+  // the header and the whole index, mapped once, they never move
+  ArchiveHeader *header;
+  ArchiveEntry *entries;
+  size_t mapSize;
+};
+
+static size_t ArchiveGetDataStart(uint32_t capacity);
+static Archive *ArchiveMap(int fd, bool isAppending);
+
+// A new empty archive opened for appending, NULL if the file already exists or can't be written
+Archive *ArchiveCreate(const char *path, uint32_t capacity) {
+  const int fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (fd < 0) {
+    return NULL;
+  }
+  const ArchiveHeader header = {
+      .magic = ARCHIVE_MAGIC,
+      .version = ARCHIVE_VERSION,
+      .entrySize = sizeof(ArchiveEntry),
+      .capacity = capacity,
+      .dataEnd = ArchiveGetDataStart(capacity),
+  };
+  if (capacity == 0 || ftruncate(fd, header.dataEnd) != 0 || pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+    close(fd);
+    unlink(path);
+    return NULL;
+  }
+  return ArchiveMap(fd, true);
+}
+
+// Only one process can have an archive open for appending, a second one gets NULL with errno EWOULDBLOCK
+Archive *ArchiveOpen(const char *path, bool isAppending) {
+  const int fd = open(path, isAppending ? O_RDWR : O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+  return ArchiveMap(fd, isAppending);
+}
+
+void ArchiveClose(Archive *archive) {
+  if (!archive) {
+    return;
+  }
+  if (archive->isAppending) {
+    msync(archive->header, archive->mapSize, MS_SYNC);
+    fsync(archive->fd);
+  }
+  munmap(archive->header, archive->mapSize);
+  close(archive->fd);
+  free(archive);
+}
+
+// Entries below this are complete and stay as they are
+uint32_t ArchiveGetCount(const Archive *archive) { return __atomic_load_n(&archive->header->count, __ATOMIC_ACQUIRE); }
+
+uint32_t ArchiveGetCapacity(const Archive *archive) { return archive->header->capacity; }
+
+const ArchiveEntry *ArchiveGetEntries(const Archive *archive) { return archive->entries; }
+
+// Copies a whole replay file's bytes in and indexes it under player. False with errno ENOSPC once the index is full,
+// or EINVAL if the bytes aren't a replay.
+bool ArchiveAppend(Archive *archive, uint64_t player, const void *replay, uint32_t length) {
+  ArchiveHeader *header = archive->header;
+  const uint32_t count = header->count;
+  if (count == header->capacity) {
+    errno = ENOSPC;
+    return false;
+  }
+  // version 1 headers stop before the keyframe fields, they stay zero
+  ReplayHeader replayHeader = {0};
+  memcpy(&replayHeader, replay, MIN(length, sizeof(ReplayHeader)));
+  if (length < offsetof(ReplayHeader, keyframeInterval) || replayHeader.magic != REPLAY_MAGIC) {
+    errno = EINVAL;
+    return false;
+  }
+  // past the published end, readers can't see any of it until the count goes up
+  for (uint32_t written = 0; written < length;) {
+    const ssize_t result = pwrite(archive->fd, (const char *)replay + written, length - written, header->dataEnd + written);
+    if (result == 0) {
+      // some filesystems report a full disk or a quota this way, retrying would spin forever
+      errno = ENOSPC;
+      return false;
+    }
+    if (result < 0 && errno != EINTR) {
+      return false;
+    }
+    written += result > 0 ? result : 0;
+  }
+  archive->entries[count] = (ArchiveEntry){
+      .player = player,
+      .seed = replayHeader.seed,
+      .offset = header->dataEnd,
+      .length = length,
+      .score = replayHeader.score,
+      .linesCleared = replayHeader.linesCleared,
+      .frameCount = replayHeader.frameCount,
+      .level = replayHeader.level,
+      .startingLevel = replayHeader.startingLevel,
+      .flags = replayHeader.flags,
+  };
+  header->dataEnd += length;
+  __atomic_store_n(&header->count, count + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+// Reads the replay of an entry below the count into replay, which needs room for entry->length bytes
+bool ArchiveRead(const Archive *archive, const ArchiveEntry *entry, void *replay) {
+  for (uint32_t read = 0; read < entry->length;) {
+    const ssize_t result = pread(archive->fd, (char *)replay + read, entry->length - read, entry->offset + read);
+    if (result == 0 || (result < 0 && errno != EINTR)) {
+      return false;
+    }
+    read += result > 0 ? result : 0;
+  }
+  return true;
+}
+
+static size_t ArchiveGetDataStart(uint32_t capacity) {
+  const size_t indexEnd = ARCHIVE_PAGE_SIZE + (size_t)capacity * sizeof(ArchiveEntry);
+  return (indexEnd + ARCHIVE_PAGE_SIZE - 1) / ARCHIVE_PAGE_SIZE * ARCHIVE_PAGE_SIZE;
+}
+
+// Takes the fd, closing it on failure
+static Archive *ArchiveMap(int fd, bool isAppending) {
+  ArchiveHeader header;
+  if (pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) || header.magic != ARCHIVE_MAGIC ||
+      header.version != ARCHIVE_VERSION || header.entrySize != sizeof(ArchiveEntry)) {
+    close(fd);
+    errno = EINVAL;
+    return NULL;
+  }
+  Archive *archive = calloc(1, sizeof(Archive));
+  if (!archive || (isAppending && flock(fd, LOCK_EX | LOCK_NB) != 0)) {
+    free(archive);
+    close(fd);
+    return NULL;
+  }
+  archive->fd = fd;
+  archive->isAppending = isAppending;
+  archive->mapSize = ArchiveGetDataStart(header.capacity);
+  archive->header = mmap(NULL, archive->mapSize, PROT_READ | (isAppending ? PROT_WRITE : 0), MAP_SHARED, fd, 0);
+  if (archive->header == MAP_FAILED) {
+    free(archive);
+    close(fd);
+    return NULL;
+  }
+  archive->entries = (ArchiveEntry *)((char *)archive->header + ARCHIVE_PAGE_SIZE);
+  return archive;
+}
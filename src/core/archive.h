@@ -0,0 +1,54 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ARCHIVE_MAGIC 0x31415254 // "TRA1"
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_DEFAULT_CAPACITY (1 << 20)
+// the index starts on the second page, the replays after the last page of the index
+#define ARCHIVE_PAGE_SIZE 4096
+
+// One replay in the archive, the fixed-width records a scan reads straight out of the mapping.
+// Everything but player and the position comes from the replay's own header.
+typedef struct {
+  uint64_t player;
+  uint64_t seed;
+  // from the start of the archive
+  uint64_t offset;
+  uint32_t length;
+  int32_t score;
+  uint32_t linesCleared;
+  uint32_t frameCount;
+  uint16_t level;
+  uint16_t startingLevel;
+  uint32_t flags;
+} ArchiveEntry;
+
+typedef struct {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t entrySize;
+  // entries the index has room for, the file is created sparse so the unused part costs nothing
+  uint32_t capacity;
+  // entries below count are complete, the appender stores it last with release ordering
+  uint32_t count;
+  uint64_t dataEnd;
+} ArchiveHeader;
+
+// An append-only file of replays, a header and index at the front and the replays themselves after it.
+// One process appends while any number read: the index is mapped shared, so a reader loading the count with acquire ordering
+// sees every entry below it and the replay bytes behind them, with no locks and nothing to parse.
+typedef struct Archive Archive;
+
+Archive *ArchiveCreate(const char *path, uint32_t capacity);
+Archive *ArchiveOpen(const char *path, bool isAppending);
+void ArchiveClose(Archive *archive);
+uint32_t ArchiveGetCount(const Archive *archive);
+uint32_t ArchiveGetCapacity(const Archive *archive);
+const ArchiveEntry *ArchiveGetEntries(const Archive *archive);
+bool ArchiveAppend(Archive *archive, uint64_t player, const void *replay, uint32_t length);
+bool ArchiveRead(const Archive *archive, const ArchiveEntry *entry, void *replay);
+
+#endif // ARCHIVE_H
@@ -0,0 +1,40 @@
+#include "board.h"
+
+void BoardReset(Board *board) {
+  for (int row = 0; row < ROWS; row++) {
+    board->rows[row] = BOARD_EMPTY_ROW;
+    board->shapeTypes[row] = 0;
+  }
+  for (int row = ROWS; row < ROWS + BOARD_FLOOR_ROWS; row++) {
+    board->rows[row] = BOARD_FULL_ROW;
+  }
+}
+
+// bit N of the result is set when row N is full, only rows in [top, bottom] are checked
+uint32_t BoardGetFullRows(const Board *board, int top, int bottom) {
+  uint32_t fullRows = 0;
+  for (int row = top; row <= bottom; row++) {
+    fullRows |= (uint32_t)(board->rows[row] == BOARD_FULL_ROW) << row;
+  }
+  return fullRows;
+}
+
+// Compacts the board in a single pass from the lowest cleared row upwards, rows below it never move
+void BoardClearRows(Board *board, uint32_t rows) {
+  if (!rows) {
+    return;
+  }
+  int destination = 31 - __builtin_clz(rows);
+  for (int row = destination; row >= 0; row--) {
+    if (rows & (1u << row)) {
+      continue;
+    }
+    board->rows[destination] = board->rows[row];
+    board->shapeTypes[destination] = board->shapeTypes[row];
+    destination--;
+  }
+  for (; destination >= 0; destination--) {
+    board->rows[destination] = BOARD_EMPTY_ROW;
+    board->shapeTypes[destination] = 0;
+  }
+}
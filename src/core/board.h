@@ -0,0 +1,31 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <stdint.h>
+
+#define BUFFER_ROWS 2
+#define PLAYFIELD_ROWS 20
+#define ROWS (BUFFER_ROWS + PLAYFIELD_ROWS)
+#define COLUMNS 10
+// board rows are padded with always-occupied wall columns on both sides and always-full floor rows below,
+// so a piece hanging over any edge collides without needing a bounds check
+#define BOARD_WALL_WIDTH 3
+#define BOARD_FLOOR_ROWS 4
+#define BOARD_CELL(X) (1 << ((X) + BOARD_WALL_WIDTH))
+#define BOARD_FULL_ROW 0xFFFF
+#define BOARD_EMPTY_ROW (BOARD_FULL_ROW & ~(((1 << COLUMNS) - 1) << BOARD_WALL_WIDTH))
+#define BOARD_SHAPE_TYPE_BITS 3
+#define BOARD_SHAPE_TYPE(BOARD, X, Y) (((BOARD)->shapeTypes[Y] >> (BOARD_SHAPE_TYPE_BITS * (X))) & 7)
+
+typedef struct {
+  // one bit per column, BOARD_CELL(X) is set when column X is occupied
+  uint16_t rows[ROWS + BOARD_FLOOR_ROWS];
+  // BOARD_SHAPE_TYPE_BITS per column, read with BOARD_SHAPE_TYPE, always 0 for empty cells
+  uint32_t shapeTypes[ROWS];
+} Board;
+
+void BoardReset(Board *board);
+uint32_t BoardGetFullRows(const Board *board, int top, int bottom);
+void BoardClearRows(Board *board, uint32_t rows);
+
+#endif // BOARD_H
@@ -0,0 +1,100 @@
+#include <stdlib.h>
+
+#include "env.h"
+
+static void EnvResetGame(Env *env, int index);
+static void EnvObserve(const Env *env, EnvObservation *observation, int index);
+
+// NULL without games or for a startingLevel the game can't start on
+Env *EnvCreate(int count, int startingLevel, uint64_t seed) {
+  if (count < 1 || startingLevel < 0 || startingLevel > SIM_MAX_STARTING_LEVEL) {
+    return NULL;
+  }
+  Env *env = calloc(1, sizeof(Env));
+  if (!env) {
+    return NULL;
+  }
+  env->count = count;
+  env->startingLevel = startingLevel;
+  env->seed = seed;
+  env->games = malloc(count * sizeof(SimState));
+  env->episodes = calloc(count, sizeof(uint32_t));
+  if (!env->games || !env->episodes) {
+    EnvDestroy(env);
+    return NULL;
+  }
+  return env;
+}
+
+void EnvDestroy(Env *env) {
+  if (!env) {
+    return;
+  }
+  free(env->games);
+  free(env->episodes);
+  free(env);
+}
+
+// Starts every game from episode 0 and fills the first observation
+void EnvReset(Env *env, EnvObservation *observation) {
+  for (int i = 0; i < env->count; i++) {
+    env->episodes[i] = 0;
+    EnvResetGame(env, i);
+    EnvObserve(env, observation, i);
+  }
+}
+
+// actions[I] is the SimStep input mask for game I, rewards[I] the points it scored this frame and dones[I] is 1 when it topped out.
+// A finished game is reset right away, its observation is already the first frame of the next episode.
+void EnvStep(Env *env, const uint8_t *actions, EnvObservation *observation, float *rewards, uint8_t *dones) {
+  for (int i = 0; i < env->count; i++) {
+    SimState *game = &env->games[i];
+    const int score = game->score;
+    SimStep(game, actions[i]);
+    rewards[i] = (float)(game->score - score);
+    dones[i] = game->isGameOver;
+    if (game->isGameOver) {
+      env->episodes[i]++;
+      EnvResetGame(env, i);
+    }
+    EnvObserve(env, observation, i);
+  }
+}
+
+static void EnvResetGame(Env *env, int index) {
+  SimReset(&env->games[index], RngStreamSeed(env->seed, (uint64_t)index << 32 | env->episodes[index]));
+  SimStart(&env->games[index], env->startingLevel);
+}
+
+static void EnvObserve(const Env *env, EnvObservation *observation, int index) {
+  const SimState *game = &env->games[index];
+  if (observation->rows) {
+    for (int y = 0; y < ROWS; y++) {
+      observation->rows[y * env->count + index] = game->board.rows[y];
+    }
+  }
+  if (observation->currentType) {
+    observation->currentType[index] = game->currentPiece.type;
+  }
+  if (observation->currentX) {
+    observation->currentX[index] = game->currentPiece.x;
+  }
+  if (observation->currentY) {
+    observation->currentY[index] = game->currentPiece.y;
+  }
+  if (observation->currentRotation) {
+    observation->currentRotation[index] = game->currentPiece.rotationIndex;
+  }
+  if (observation->nextType) {
+    observation->nextType[index] = game->nextPiece.type;
+  }
+  if (observation->level) {
+    observation->level[index] = game->currentLevel;
+  }
+  if (observation->linesCleared) {
+    observation->linesCleared[index] = game->linesCleared;
+  }
+  if (observation->score) {
+    observation->score[index] = game->score;
+  }
+}
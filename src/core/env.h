@@ -0,0 +1,40 @@
+#ifndef ENV_H
+#define ENV_H
+
+#include <stdint.h>
+
+#include "sim.h"
+
+// Caller-owned output arrays, one entry per game, copied out of the games by EnvReset and EnvStep.
+// rows[Y * count + I] is row Y of game I (walls included, floor left out), so the same row of every game is contiguous.
+// The board copy is most of an observation's cost, leave rows NULL if the boards aren't needed every step.
+// Any pointer can be NULL to skip that field.
+typedef struct {
+  uint16_t *rows;
+  uint8_t *currentType;
+  int8_t *currentX;
+  int8_t *currentY;
+  uint8_t *currentRotation;
+  uint8_t *nextType;
+  uint8_t *level;
+  int32_t *linesCleared;
+  int32_t *score;
+} EnvObservation;
+
+// N independent games stepped one frame at a time by SimStep, so they follow the exact rules of the game.
+// Each game stays a whole SimState rather than being split into per-field arrays, since SimStep is the only copy of the rules.
+typedef struct {
+  int count;
+  int startingLevel;
+  uint64_t seed;
+  SimState *games;
+  // finished games are reset with the seed of their next episode
+  uint32_t *episodes;
+} Env;
+
+Env *EnvCreate(int count, int startingLevel, uint64_t seed);
+void EnvDestroy(Env *env);
+void EnvReset(Env *env, EnvObservation *observation);
+void EnvStep(Env *env, const uint8_t *actions, EnvObservation *observation, float *rewards, uint8_t *dones);
+
+#endif // ENV_H
@@ -0,0 +1,131 @@
+#include "movegen.h"
+
+// Bit (x + BOARD_WALL_WIDTH) of a position mask stands for the piece at column x, the same offset PieceFits uses
+#define POSITION_BIT_OFFSET BOARD_WALL_WIDTH
+
+static uint16_t MovegenFitMask(const Board *board, const PieceConfiguration *rotation, int y);
+static uint16_t MovegenFlood(uint16_t reachable, uint16_t fits);
+static uint16_t MovegenShift(uint16_t mask, int dx);
+static void MovegenRemoveDuplicates(const PieceType *pieceType, uint16_t locks[4][ROWS]);
+
+// Enumerates every lock position reachable from the piece's current position with rotations, left, right and down moves.
+// Rotations have no kicks and the piece never moves up, like SimStep, but DAS and gravity timing are not modelled.
+// Placements that leave the same cells filled (the I, S, Z and O rotations that are translations of each other) are listed once.
+void MovegenPlacements(const Board *board, const Piece *piece, PlacementList *list) {
+  const PieceType *pieceType = &tetrominoes[piece->type];
+  uint16_t locks[4][ROWS] = {{0}};
+  uint16_t reachable[4] = {0};
+  uint16_t fits[4];
+  uint16_t fitsBelow[4];
+  list->count = 0;
+
+  for (int r = 0; r < 4; r++) {
+    fits[r] = MovegenFitMask(board, &pieceType->rotations[r], piece->y);
+  }
+  reachable[piece->rotationIndex] = fits[piece->rotationIndex] & (1 << (piece->x + POSITION_BIT_OFFSET));
+
+  for (int y = piece->y; y < ROWS; y++) {
+    // alternate sideways floods and rotations until neither adds a position on this row
+    uint16_t changed = 1;
+    while (changed) {
+      changed = 0;
+      for (int r = 0; r < 4; r++) {
+        reachable[r] = MovegenFlood(reachable[r], fits[r]);
+      }
+      for (int r = 0; r < 4; r++) {
+        const uint16_t rotated = (reachable[(r + 1) & 3] | reachable[(r + 3) & 3]) & fits[r] & ~reachable[r];
+        reachable[r] |= rotated;
+        changed |= rotated;
+      }
+    }
+
+    uint16_t anyBelow = 0;
+    for (int r = 0; r < 4; r++) {
+      fitsBelow[r] = y + 1 < ROWS ? MovegenFitMask(board, &pieceType->rotations[r], y + 1) : 0;
+      locks[r][y] = reachable[r] & ~fitsBelow[r];
+      reachable[r] &= fitsBelow[r];
+      fits[r] = fitsBelow[r];
+      anyBelow |= reachable[r];
+    }
+    if (!anyBelow) {
+      break;
+    }
+  }
+
+  MovegenRemoveDuplicates(pieceType, locks);
+  for (int r = 0; r < 4; r++) {
+    for (int y = piece->y; y < ROWS; y++) {
+      uint32_t mask = locks[r][y];
+      while (mask) {
+        list->placements[list->count++] = (Placement){__builtin_ctz(mask) - POSITION_BIT_OFFSET, y, r};
+        mask &= mask - 1;
+      }
+    }
+  }
+}
+
+// Locks the piece at the placement and clears the rows it completes, returns how many it cleared
+int MovegenApplyPlacement(Board *board, int type, const Placement *placement) {
+  const Piece piece = {type, placement->x, placement->y, placement->rotationIndex};
+  const PieceConfiguration *rotation = &tetrominoes[type].rotations[placement->rotationIndex];
+  PieceLock(&piece, board);
+  const uint32_t fullRows = BoardGetFullRows(board, placement->y + rotation->minY, placement->y + rotation->maxY);
+  BoardClearRows(board, fullRows);
+  return __builtin_popcount(fullRows);
+}
+
+// Bit (x + BOARD_WALL_WIDTH) is set when the rotation fits at (x, y), built a row at a time instead of a PieceFits per column
+static uint16_t MovegenFitMask(const Board *board, const PieceConfiguration *rotation, int y) {
+  uint32_t blocked = 0;
+  for (int dy = 0; dy < 4; dy++) {
+    // anything shifted in from past the right wall counts as occupied
+    const uint32_t row = board->rows[y + dy] | 0xFFFF0000u;
+    uint32_t cells = rotation->rowMasks[dy];
+    while (cells) {
+      blocked |= row >> __builtin_ctz(cells);
+      cells &= cells - 1;
+    }
+  }
+  return (uint16_t)~blocked;
+}
+
+// Spreads the reachable positions sideways through the positions that fit
+static uint16_t MovegenFlood(uint16_t reachable, uint16_t fits) {
+  uint16_t previous;
+  do {
+    previous = reachable;
+    reachable |= (uint16_t)((reachable << 1) | (reachable >> 1)) & fits;
+  } while (reachable != previous);
+  return reachable;
+}
+
+static uint16_t MovegenShift(uint16_t mask, int dx) { return dx >= 0 ? mask >> dx : (uint16_t)(mask << -dx); }
+
+// When rotation r covers the same cells as an earlier rotation moved by (dx, dy), its lock positions are already listed
+static void MovegenRemoveDuplicates(const PieceType *pieceType, uint16_t locks[4][ROWS]) {
+  for (int r = 1; r < 4; r++) {
+    const PieceConfiguration *rotation = &pieceType->rotations[r];
+    for (int earlier = 0; earlier < r; earlier++) {
+      const PieceConfiguration *other = &pieceType->rotations[earlier];
+      bool isSameShape = true;
+      for (int dy = 0; dy < 4; dy++) {
+        const int y = rotation->minY + dy;
+        const int otherY = other->minY + dy;
+        const int cells = y < 4 ? rotation->rowMasks[y] >> rotation->minX : 0;
+        const int otherCells = otherY < 4 ? other->rowMasks[otherY] >> other->minX : 0;
+        isSameShape &= cells == otherCells;
+      }
+      if (!isSameShape) {
+        continue;
+      }
+      const int dx = rotation->minX - other->minX;
+      const int dy = rotation->minY - other->minY;
+      for (int y = 0; y < ROWS; y++) {
+        if (y + dy >= 0 && y + dy < ROWS) {
+          locks[r][y] &= ~MovegenShift(locks[earlier][y + dy], dx);
+        }
+      }
+      break;
+    }
+  }
+}
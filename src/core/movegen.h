@@ -0,0 +1,26 @@
+#ifndef MOVEGEN_H
+#define MOVEGEN_H
+
+#include <stdint.h>
+
+#include "board.h"
+#include "tetromino.h"
+
+// every (rotation, x, y) a piece can occupy, so no board can produce more lock positions than this
+#define MOVEGEN_MAX_PLACEMENTS (4 * 16 * ROWS)
+
+typedef struct {
+  int8_t x;
+  int8_t y;
+  int8_t rotationIndex;
+} Placement;
+
+typedef struct {
+  int count;
+  Placement placements[MOVEGEN_MAX_PLACEMENTS];
+} PlacementList;
+
+void MovegenPlacements(const Board *board, const Piece *piece, PlacementList *list);
+int MovegenApplyPlacement(Board *board, int type, const Placement *placement);
+
+#endif // MOVEGEN_H
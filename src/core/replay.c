@@ -0,0 +1,327 @@
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "replay.h"
+#include "snapshot.h"
+#include "util.h"
+
+#define REPLAY_SHORT_RUNS 6
+#define REPLAY_LONG_RUN 6
+#define REPLAY_ALTERNATION 7
+// taps shorter than this are cheaper as plain runs
+#define REPLAY_MIN_ALTERNATION 4
+#define REPLAY_VERSION_1_HEADER_SIZE 32
+
+struct ReplayWriter {
+  FILE *file;
+  // where the header went, it's written again with the results at the end
+  long start;
+  ReplayHeader header;
+  uint8_t runInput;
+  uint32_t runLength;
+  // single frame runs going back and forth between two inputs, a button tapped every other frame
+  uint8_t tapInputs[2];
+  uint32_t tapCount;
+  uint32_t *keyframeOffsets;
+  uint32_t keyframeCount;
+  uint32_t keyframeCapacity;
+  bool isFailed;
+};
+
+struct ReplayReader {
+  FILE *file;
+  long start;
+  long headerSize;
+  ReplayHeader header;
+  uint32_t frame;
+  // the frame of the keyframe last read or seeked to, the runs after it come next
+  uint32_t keyframeFrame;
+  uint8_t runInput;
+  uint32_t runLeft;
+  // while alternating, runInput and otherInput swap every frame
+  bool isAlternating;
+  uint8_t otherInput;
+};
+
+static void ReplayWriterAddKeyframe(ReplayWriter *writer, const SimState *state);
+static void ReplayWriterAddRun(ReplayWriter *writer);
+static void ReplayWriterFlushTaps(ReplayWriter *writer);
+static void ReplayWriterPutRun(ReplayWriter *writer, uint8_t input, uint32_t length);
+static void ReplayWriterPutVarint(ReplayWriter *writer, uint32_t value);
+static bool ReplayReaderGetVarint(ReplayReader *reader, uint32_t *value);
+
+// Writes the header for a game that was just started at the current position of file, which stays the caller's to close.
+// state is the game after SimStart, with previousInput already set, keyframeInterval is usually REPLAY_KEYFRAME_INTERVAL.
+ReplayWriter *ReplayWriterCreate(FILE *file, uint64_t seed, const SimState *state, uint32_t keyframeInterval) {
+  ReplayWriter *writer = calloc(1, sizeof(ReplayWriter));
+  if (!writer) {
+    return NULL;
+  }
+  writer->file = file;
+  writer->start = ftell(file);
+  writer->header = (ReplayHeader){
+      .magic = REPLAY_MAGIC,
+      .version = REPLAY_VERSION,
+      .startingLevel = state->startingLevel,
+      .previousInput = state->previousInput,
+      .seed = seed,
+      .keyframeInterval = keyframeInterval,
+  };
+  if (writer->start < 0 || fwrite(&writer->header, sizeof(ReplayHeader), 1, file) != 1) {
+    free(writer);
+    return NULL;
+  }
+  return writer;
+}
+
+// The input passed to one SimStep and the state that step left, kept whole every keyframeInterval frames
+void ReplayWriterAdd(ReplayWriter *writer, uint8_t input, const SimState *state) {
+  input &= REPLAY_INPUT_MASK;
+  if (writer->runLength > 0 && input != writer->runInput) {
+    ReplayWriterAddRun(writer);
+  }
+  writer->runInput = input;
+  writer->runLength++;
+  writer->header.frameCount++;
+  if (writer->header.keyframeInterval > 0 && writer->header.frameCount % writer->header.keyframeInterval == 0) {
+    ReplayWriterAddKeyframe(writer, state);
+  }
+}
+
+// Writes the last run and the results of state into the header, then frees the writer. False if anything failed to write.
+bool ReplayWriterFinish(ReplayWriter *writer, const SimState *state) {
+  FILE *file = writer->file;
+  if (writer->runLength > 0) {
+    ReplayWriterAddRun(writer);
+  }
+  ReplayWriterFlushTaps(writer);
+  writer->header.indexOffset = ftell(file) - writer->start;
+  fwrite(writer->keyframeOffsets, sizeof(uint32_t), writer->keyframeCount, file);
+  writer->header.score = state->score;
+  writer->header.linesCleared = state->linesCleared;
+  writer->header.level = state->currentLevel;
+  writer->header.flags = state->isGameOver ? REPLAY_FLAG_GAME_OVER : 0;
+  const long end = ftell(file);
+  const bool isWritten = !writer->isFailed && end >= 0 && fseek(file, writer->start, SEEK_SET) == 0 &&
+                         fwrite(&writer->header, sizeof(ReplayHeader), 1, file) == 1 && fseek(file, end, SEEK_SET) == 0 &&
+                         fflush(file) == 0 && !ferror(file);
+  free(writer->keyframeOffsets);
+  free(writer);
+  return isWritten;
+}
+
+// The runs so far end here so a reader restoring the snapshot can go on reading runs right after it
+static void ReplayWriterAddKeyframe(ReplayWriter *writer, const SimState *state) {
+  ReplayWriterAddRun(writer);
+  ReplayWriterFlushTaps(writer);
+  if (writer->keyframeCount == writer->keyframeCapacity) {
+    const uint32_t capacity = writer->keyframeCapacity ? 2 * writer->keyframeCapacity : 64;
+    uint32_t *offsets = realloc(writer->keyframeOffsets, capacity * sizeof(uint32_t));
+    if (offsets) {
+      writer->keyframeOffsets = offsets;
+      writer->keyframeCapacity = capacity;
+    }
+  }
+  if (writer->keyframeCount < writer->keyframeCapacity) {
+    writer->keyframeOffsets[writer->keyframeCount++] = ftell(writer->file) - writer->start;
+  } else {
+    writer->isFailed = true;
+  }
+  // readers expect the snapshot here even when it can't be indexed
+  SimSnapshot snapshot;
+  SimSave(state, &snapshot);
+  fwrite(&snapshot, sizeof(SimSnapshot), 1, writer->file);
+}
+
+// Single frame runs are held back while they keep alternating, the finished run is either the next tap or ends them
+static void ReplayWriterAddRun(ReplayWriter *writer) {
+  const uint8_t input = writer->runInput;
+  const uint32_t length = writer->runLength;
+  writer->runLength = 0;
+  if (length == 1 && (writer->tapCount < 2 || input == writer->tapInputs[writer->tapCount % 2])) {
+    if (writer->tapCount < 2) {
+      writer->tapInputs[writer->tapCount] = input;
+    }
+    writer->tapCount++;
+    return;
+  }
+  ReplayWriterFlushTaps(writer);
+  if (length == 1) {
+    writer->tapInputs[0] = input;
+    writer->tapCount = 1;
+    return;
+  }
+  ReplayWriterPutRun(writer, input, length);
+}
+
+static void ReplayWriterFlushTaps(ReplayWriter *writer) {
+  if (writer->tapCount >= REPLAY_MIN_ALTERNATION) {
+    fputc(writer->tapInputs[0] | REPLAY_ALTERNATION << 5, writer->file);
+    fputc(writer->tapInputs[1], writer->file);
+    ReplayWriterPutVarint(writer, writer->tapCount - REPLAY_MIN_ALTERNATION);
+  } else {
+    for (uint32_t i = 0; i < writer->tapCount; i++) {
+      ReplayWriterPutRun(writer, writer->tapInputs[i % 2], 1);
+    }
+  }
+  writer->tapCount = 0;
+}
+
+static void ReplayWriterPutRun(ReplayWriter *writer, uint8_t input, uint32_t length) {
+  if (length <= REPLAY_SHORT_RUNS) {
+    fputc(input | (length - 1) << 5, writer->file);
+    return;
+  }
+  fputc(input | REPLAY_LONG_RUN << 5, writer->file);
+  ReplayWriterPutVarint(writer, length - REPLAY_SHORT_RUNS - 1);
+}
+
+// LEB128, 7 bits per byte with the top bit set on all but the last
+static void ReplayWriterPutVarint(ReplayWriter *writer, uint32_t value) {
+  for (; value >= 0x80; value >>= 7) {
+    fputc((value & 0x7f) | 0x80, writer->file);
+  }
+  fputc(value, writer->file);
+}
+
+// Reads the header at the current position of file, NULL if it isn't a replay this version can play.
+// The inputs are then read one run at a time, however long the game was, seeking also needs a file that can seek.
+ReplayReader *ReplayReaderCreate(FILE *file) {
+  ReplayReader *reader = calloc(1, sizeof(ReplayReader));
+  if (!reader) {
+    return NULL;
+  }
+  reader->file = file;
+  reader->start = ftell(file);
+  ReplayHeader *header = &reader->header;
+  const size_t extraSize = sizeof(ReplayHeader) - REPLAY_VERSION_1_HEADER_SIZE;
+  bool isValid = fread(header, REPLAY_VERSION_1_HEADER_SIZE, 1, file) == 1 && header->magic == REPLAY_MAGIC;
+  if (isValid && header->version == 1) {
+    // no keyframes
+    reader->headerSize = REPLAY_VERSION_1_HEADER_SIZE;
+  } else {
+    char *extra = (char *)header + offsetof(ReplayHeader, keyframeInterval);
+    isValid = isValid && header->version == REPLAY_VERSION && fread(extra, extraSize, 1, file) == 1;
+    reader->headerSize = sizeof(ReplayHeader);
+  }
+  if (!isValid) {
+    free(reader);
+    return NULL;
+  }
+  return reader;
+}
+
+void ReplayReaderDestroy(ReplayReader *reader) { free(reader); }
+
+const ReplayHeader *ReplayReaderGetHeader(const ReplayReader *reader) { return &reader->header; }
+
+// The number of inputs read so far
+uint32_t ReplayReaderGetFrame(const ReplayReader *reader) { return reader->frame; }
+
+// The input for the next SimStep, false after the last one or when the file ends early
+bool ReplayReaderNext(ReplayReader *reader, uint8_t *input) {
+  if (reader->frame >= reader->header.frameCount) {
+    return false;
+  }
+  const uint32_t interval = reader->header.keyframeInterval;
+  const bool isAtKeyframe = interval > 0 && reader->frame > 0 && reader->frame % interval == 0 && reader->frame != reader->keyframeFrame;
+  if (reader->runLeft == 0 && isAtKeyframe) {
+    // read rather than seeked over, the file might be a pipe
+    SimSnapshot keyframe;
+    if (fread(&keyframe, sizeof(SimSnapshot), 1, reader->file) != 1) {
+      return false;
+    }
+    reader->keyframeFrame = reader->frame;
+  }
+  if (reader->runLeft == 0) {
+    const int run = fgetc(reader->file);
+    if (run == EOF) {
+      return false;
+    }
+    const int kind = run >> 5;
+    reader->runInput = run & REPLAY_INPUT_MASK;
+    reader->isAlternating = kind == REPLAY_ALTERNATION;
+    if (kind < REPLAY_SHORT_RUNS) {
+      reader->runLeft = kind + 1;
+    } else if (kind == REPLAY_LONG_RUN) {
+      if (!ReplayReaderGetVarint(reader, &reader->runLeft)) {
+        return false;
+      }
+      reader->runLeft += REPLAY_SHORT_RUNS + 1;
+    } else {
+      const int other = fgetc(reader->file);
+      if (other == EOF || !ReplayReaderGetVarint(reader, &reader->runLeft)) {
+        return false;
+      }
+      reader->otherInput = other & REPLAY_INPUT_MASK;
+      reader->runLeft += REPLAY_MIN_ALTERNATION;
+    }
+  }
+  *input = reader->runInput;
+  if (reader->isAlternating) {
+    reader->runInput = reader->otherInput;
+    reader->otherInput = *input;
+  }
+  reader->runLeft--;
+  reader->frame++;
+  return true;
+}
+
+static bool ReplayReaderGetVarint(ReplayReader *reader, uint32_t *value) {
+  *value = 0;
+  for (int shift = 0; shift < 32; shift += 7) {
+    const int byte = fgetc(reader->file);
+    if (byte == EOF) {
+      return false;
+    }
+    *value |= (uint32_t)(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Puts state at frame by restoring the last keyframe before it and stepping the rest, the next input read is the one for frame.
+// False if the file can't seek or is cut short.
+bool ReplayReaderSeek(ReplayReader *reader, uint32_t frame, SimState *state) {
+  const ReplayHeader *header = &reader->header;
+  frame = MIN(frame, header->frameCount);
+  const uint32_t keyframe = header->keyframeInterval > 0 ? frame / header->keyframeInterval : 0;
+  reader->runLeft = 0;
+  reader->isAlternating = false;
+  if (keyframe == 0) {
+    if (fseek(reader->file, reader->start + reader->headerSize, SEEK_SET) != 0) {
+      return false;
+    }
+    ReplayStart(header, state);
+    reader->frame = 0;
+    reader->keyframeFrame = 0;
+  } else {
+    uint32_t offset;
+    SimSnapshot snapshot;
+    if (fseek(reader->file, reader->start + header->indexOffset + (keyframe - 1) * sizeof(uint32_t), SEEK_SET) != 0 ||
+        fread(&offset, sizeof(uint32_t), 1, reader->file) != 1 || fseek(reader->file, reader->start + offset, SEEK_SET) != 0 ||
+        fread(&snapshot, sizeof(SimSnapshot), 1, reader->file) != 1) {
+      return false;
+    }
+    SimRestore(state, &snapshot);
+    reader->frame = keyframe * header->keyframeInterval;
+    reader->keyframeFrame = reader->frame;
+  }
+  uint8_t input;
+  while (reader->frame < frame) {
+    if (!ReplayReaderNext(reader, &input)) {
+      return false;
+    }
+    SimStep(state, input);
+  }
+  return true;
+}
+
+// Sets state up as the recorded game was before its first frame
+void ReplayStart(const ReplayHeader *header, SimState *state) {
+  SimReset(state, header->seed);
+  SimStart(state, header->startingLevel);
+  state->previousInput = header->previousInput;
+}
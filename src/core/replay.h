@@ -0,0 +1,62 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "sim.h"
+
+#define REPLAY_MAGIC 0x31505254 // "TRP1"
+#define REPLAY_VERSION 2
+// half a minute, seeking anywhere then replays at most this many frames
+#define REPLAY_KEYFRAME_INTERVAL 1800
+// the InputButton bits, the only ones a recorded input can have
+#define REPLAY_INPUT_MASK 0x1f
+
+typedef enum {
+  REPLAY_FLAG_GAME_OVER = 1 << 0,
+} ReplayFlag;
+
+// The fixed 40 bytes a replay file starts with, little-endian like the hosts that write them (version 1 stopped after flags).
+// The game is SimReset(seed), SimStart(startingLevel) and previousInput set, then frameCount SimSteps with the recorded inputs.
+// The results are filled in when the writer closes, a reader checks them against its own re-simulation.
+typedef struct {
+  uint32_t magic;
+  uint16_t version;
+  uint8_t startingLevel;
+  uint8_t previousInput;
+  uint64_t seed;
+  uint32_t frameCount;
+  int32_t score;
+  uint32_t linesCleared;
+  uint16_t level;
+  uint16_t flags;
+  // 0 for no keyframes
+  uint32_t keyframeInterval;
+  // from the start of the header, like every offset in a replay
+  uint32_t indexOffset;
+} ReplayHeader;
+
+// After the header come the SimStep inputs as runs, one byte with the input in the low 5 bits and the kind in the top 3:
+// kinds 0-5 are the input held for 1-6 frames, 6 is followed by a LEB128 varint of the frames - 7, and 7 by a second input
+// and a varint of the frames - 4, the two inputs alternating every frame from the first, the way buttons are tapped.
+// Runs stop at every multiple of keyframeInterval and a SimSnapshot of the game at that frame comes in between.
+// The index at indexOffset is a uint32_t offset for each of those snapshots.
+// A ten minute level 18 bot game takes about 5 KB of inputs and 4 KB of keyframes.
+typedef struct ReplayWriter ReplayWriter;
+typedef struct ReplayReader ReplayReader;
+
+ReplayWriter *ReplayWriterCreate(FILE *file, uint64_t seed, const SimState *state, uint32_t keyframeInterval);
+void ReplayWriterAdd(ReplayWriter *writer, uint8_t input, const SimState *state);
+bool ReplayWriterFinish(ReplayWriter *writer, const SimState *state);
+
+ReplayReader *ReplayReaderCreate(FILE *file);
+void ReplayReaderDestroy(ReplayReader *reader);
+const ReplayHeader *ReplayReaderGetHeader(const ReplayReader *reader);
+uint32_t ReplayReaderGetFrame(const ReplayReader *reader);
+bool ReplayReaderNext(ReplayReader *reader, uint8_t *input);
+bool ReplayReaderSeek(ReplayReader *reader, uint32_t frame, SimState *state);
+void ReplayStart(const ReplayHeader *header, SimState *state);
+
+#endif // REPLAY_H
@@ -0,0 +1,20 @@
+#include "rng.h"
+
+void RngSeed(Rng *rng, uint64_t seed) { rng->state = seed; }
+
+uint32_t RngNext(Rng *rng) {
+  uint64_t z = (rng->state += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return (uint32_t)((z ^ (z >> 31)) >> 32);
+}
+
+// A well mixed seed for each stream of a base seed, seeding with seed + stream directly would give overlapping splitmix sequences
+uint64_t RngStreamSeed(uint64_t seed, uint64_t stream) {
+  Rng mixer;
+  RngSeed(&mixer, seed ^ (stream * 0xD1B54A32D192ED03ull));
+  return (uint64_t)RngNext(&mixer) << 32 | RngNext(&mixer);
+}
+
+// Both ends included, like raylib's GetRandomValue
+int RngRange(Rng *rng, int min, int max) { return min + (int)(((uint64_t)RngNext(rng) * (uint32_t)(max - min + 1)) >> 32); }
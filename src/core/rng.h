@@ -0,0 +1,16 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// splitmix64, small enough to live inside every game state so games never share a random stream
+typedef struct {
+  uint64_t state;
+} Rng;
+
+void RngSeed(Rng *rng, uint64_t seed);
+uint32_t RngNext(Rng *rng);
+int RngRange(Rng *rng, int min, int max);
+uint64_t RngStreamSeed(uint64_t seed, uint64_t stream);
+
+#endif // RNG_H
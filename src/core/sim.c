@@ -0,0 +1,223 @@
+#include "sim.h"
+#include "util.h"
+#include "zobrist.h"
+
+static void SimHandleInput(SimState *state, uint8_t input, uint8_t pressed);
+static void SimSpawnNextPiece(SimState *state);
+static void SimClearRows(SimState *state);
+
+static const int scoringTable[4] = {40, 100, 300, 1200};
+// frames per cell of gravity for each level
+static const int fallingSpeedTable[30] = {48, 43, 38, 33, 28, 23, 18, 13, 8, 6, 5, 5, 5, 4, 4, 4, 3, 3, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1};
+
+void SimReset(SimState *state, uint64_t seed) {
+  BoardReset(&state->board);
+  for (int i = 0; i < KEY_TIMERS_COUNT; i++) {
+    state->keyTimers[i] = 0;
+  }
+  for (int i = 0; i < PIECE_COUNT; i++) {
+    state->statistics[i] = 0;
+  }
+  RngSeed(&state->rng, seed);
+  state->startingLevel = 0;
+  state->currentLevel = 0;
+  state->score = 0;
+  state->softDropCounter = 0;
+  state->currentPiece = PieceGetRandom(&state->rng, -1);
+  state->statistics[state->currentPiece.type]++;
+  state->nextPiece = PieceGetRandom(&state->rng, state->currentPiece.type);
+  state->hash = ZobristPieceType(state->currentPiece.type);
+  state->fallingTimer = ENTRY_DELAY;
+  state->linesCleared = 0;
+  state->ARETimer = 0;
+  state->animationTimer = 0;
+  state->fullRows = 0;
+  state->previousInput = 0;
+  state->events = 0;
+  state->isGameOver = false;
+}
+
+void SimStart(SimState *state, int startingLevel) {
+  state->startingLevel = startingLevel;
+  state->currentLevel = startingLevel;
+}
+
+void SimStep(SimState *state, uint8_t input) {
+  const uint8_t pressed = input & ~state->previousInput;
+  state->previousInput = input;
+  state->events = 0;
+  if (state->isGameOver) {
+    return;
+  }
+
+  const int fallingSpeed = fallingSpeedTable[MIN(state->currentLevel, 29)];
+
+  if (state->ARETimer == 0) {
+    SimHandleInput(state, input, pressed);
+  }
+
+  if (state->fallingTimer < fallingSpeed) {
+    state->fallingTimer++;
+    return;
+  }
+
+  // Dropping Logic
+  const bool isDropped = PieceMoveDown(&state->currentPiece, &state->board);
+  if (isDropped) {
+    state->fallingTimer = 0;
+    return;
+  }
+
+  // Locking Logic
+  const PieceConfiguration *blocks = &tetrominoes[state->currentPiece.type].rotations[state->currentPiece.rotationIndex];
+  const int lockRow = state->currentPiece.y + blocks->maxY;
+  const int AREDelay = SimGetEntryDelay(lockRow);
+  if (state->ARETimer < AREDelay) {
+    state->ARETimer++;
+    return;
+  }
+
+  // Lock the piece once, the line clear animation keeps coming back here until it's done
+  const bool isAnimationStart = state->animationTimer == 0;
+  if (isAnimationStart) {
+    PieceLock(&state->currentPiece, &state->board);
+    for (int i = 0; i < 4; i++) {
+      state->hash ^= ZobristCell(state->currentPiece.x + blocks->cells[i].x, state->currentPiece.y + blocks->cells[i].y);
+    }
+    state->fullRows = BoardGetFullRows(&state->board, state->currentPiece.y + blocks->minY, lockRow);
+  }
+
+  // Clear rows and update score and generate next piece
+  const int fullRowsCount = __builtin_popcount(state->fullRows);
+  if (state->animationTimer <= LINE_CLEAR_ANIMATION_FRAMES && fullRowsCount > 0) {
+    if (isAnimationStart) {
+      state->events |= fullRowsCount == 4 ? SIM_EVENT_TETRIS : SIM_EVENT_LINECLEAR;
+    }
+    state->animationTimer++;
+    return;
+  }
+
+  if (fullRowsCount > 0) {
+    SimClearRows(state);
+  }
+
+  // Update score and lines cleared
+  if (fullRowsCount > 0) {
+    state->linesCleared += fullRowsCount;
+    state->currentLevel = SimGetLevel(state->startingLevel, state->linesCleared);
+    state->score += SimGetLineClearScore(fullRowsCount, state->currentLevel);
+  }
+
+  // Check if player lost
+  if (!PieceFits(&state->board, state->nextPiece.type, state->nextPiece.rotationIndex, INITIAL_BOARD_X, INITIAL_BOARD_Y)) {
+    state->events |= SIM_EVENT_GAMEOVER;
+    state->isGameOver = true;
+  }
+
+  SimSpawnNextPiece(state);
+}
+
+// The first level up comes after (startingLevel + 1) * 10 lines, then one every 10 lines
+int SimGetLevel(int startingLevel, int linesCleared) {
+  const int transitionPoint = (startingLevel + 1) * 10;
+  return linesCleared >= transitionPoint ? (linesCleared - transitionPoint) / 10 + startingLevel + 1 : startingLevel;
+}
+
+// Points for clearing 1 to 4 lines at once on the given level
+int SimGetLineClearScore(int linesCleared, int level) { return scoringTable[linesCleared - 1] * (level + 1); }
+
+// Frames a landed piece waits before it locks, the lower it lands the longer
+int SimGetEntryDelay(int lockRow) { return (((ROWS - lockRow - 1) + 2) / 4) * 2 + 10; }
+
+// SimSteps until the next piece spawns once the current one has landed (ARETimer is counting), 0 while it's still in play.
+// Input is ignored from landing on, so this is exact: the rest of the entry delay, the lock, and the line clear animation if any.
+int SimGetFramesUntilSpawn(const SimState *state) {
+  if (state->animationTimer > 0) {
+    return LINE_CLEAR_ANIMATION_FRAMES + 2 - state->animationTimer;
+  }
+  if (state->ARETimer == 0) {
+    return 0;
+  }
+  const PieceConfiguration *blocks = &tetrominoes[state->currentPiece.type].rotations[state->currentPiece.rotationIndex];
+  const int lockRow = state->currentPiece.y + blocks->maxY;
+  Board board = state->board;
+  PieceLock(&state->currentPiece, &board);
+  const bool clearsLines = BoardGetFullRows(&board, state->currentPiece.y + blocks->minY, lockRow) != 0;
+  return SimGetEntryDelay(lockRow) - state->ARETimer + 1 + (clearsLines ? LINE_CLEAR_ANIMATION_FRAMES + 1 : 0);
+}
+
+// Full recompute of SimState.hash, for checking the incremental one
+uint64_t SimComputeHash(const SimState *state) { return ZobristBoard(&state->board) ^ ZobristPieceType(state->currentPiece.type); }
+
+// Only rows above the lowest cleared one move, and of those only the ones whose contents changed are rehashed
+static void SimClearRows(SimState *state) {
+  const int bottom = 31 - __builtin_clz(state->fullRows);
+  uint16_t previousRows[ROWS];
+  for (int row = 0; row <= bottom; row++) {
+    previousRows[row] = state->board.rows[row];
+  }
+  BoardClearRows(&state->board, state->fullRows);
+  state->fullRows = 0;
+  for (int row = 0; row <= bottom; row++) {
+    if (previousRows[row] != state->board.rows[row]) {
+      state->hash ^= ZobristRow(row, previousRows[row]) ^ ZobristRow(row, state->board.rows[row]);
+    }
+  }
+}
+
+static void SimSpawnNextPiece(SimState *state) {
+  state->score += MAX(0, state->softDropCounter - 1);
+  state->softDropCounter = 0;
+  state->fallingTimer = 0;
+  state->ARETimer = 0;
+  state->animationTimer = 0;
+  state->hash ^= ZobristPieceType(state->currentPiece.type) ^ ZobristPieceType(state->nextPiece.type);
+  state->currentPiece = state->nextPiece;
+  state->statistics[state->currentPiece.type]++;
+  state->nextPiece = PieceGetRandom(&state->rng, state->currentPiece.type);
+  // held down can't soft drop the new piece until it's released, the timer never reaches the speed from here
+  state->keyTimers[KEY_DOWN_TIMER] = KEY_DOWN_TIMER_SPEED + 1;
+}
+
+static void SimHandleInput(SimState *state, uint8_t input, uint8_t pressed) {
+  if (pressed & INPUT_ROTATE_CLOCKWISE) {
+    PieceRotateClockwise(&state->currentPiece, &state->board);
+  }
+  if (pressed & INPUT_ROTATE_COUNTER_CLOCKWISE) {
+    PieceRotateCounterClockwise(&state->currentPiece, &state->board);
+  }
+  if (input & INPUT_LEFT) {
+    if (state->keyTimers[KEY_LEFT_TIMER] == KEY_TIMER_SPEED || (pressed & INPUT_LEFT)) {
+      state->keyTimers[KEY_LEFT_TIMER] = 0;
+      PieceMoveLeft(&state->currentPiece, &state->board);
+    } else if (state->keyTimers[KEY_LEFT_TIMER] < KEY_TIMER_SPEED) {
+      state->keyTimers[KEY_LEFT_TIMER]++;
+    }
+  } else {
+    state->keyTimers[KEY_LEFT_TIMER] = 0;
+  }
+  if (input & INPUT_RIGHT) {
+    if (state->keyTimers[KEY_RIGHT_TIMER] == KEY_TIMER_SPEED || (pressed & INPUT_RIGHT)) {
+      state->keyTimers[KEY_RIGHT_TIMER] = 0;
+      PieceMoveRight(&state->currentPiece, &state->board);
+    } else if (state->keyTimers[KEY_RIGHT_TIMER] < KEY_TIMER_SPEED) {
+      state->keyTimers[KEY_RIGHT_TIMER]++;
+    }
+  } else {
+    state->keyTimers[KEY_RIGHT_TIMER] = 0;
+  }
+
+  const int fallingSpeed = fallingSpeedTable[MIN(state->currentLevel, 29)];
+  if (input & INPUT_DOWN) {
+    if (state->keyTimers[KEY_DOWN_TIMER] == KEY_DOWN_TIMER_SPEED || (pressed & INPUT_DOWN)) {
+      state->fallingTimer = fallingSpeed;
+      state->softDropCounter++;
+      state->keyTimers[KEY_DOWN_TIMER] = 0;
+    } else if (state->keyTimers[KEY_DOWN_TIMER] < KEY_DOWN_TIMER_SPEED) {
+      state->keyTimers[KEY_DOWN_TIMER]++;
+    }
+  } else {
+    state->keyTimers[KEY_DOWN_TIMER] = 0;
+    state->softDropCounter = 0;
+  }
+}
@@ -0,0 +1,79 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "board.h"
+#include "rng.h"
+#include "tetromino.h"
+
+// one SimStep is one NES frame
+#define SIM_FRAME_RATE 60.0988
+#define KEY_DOWN_TIMER_SPEED 2
+#define KEY_TIMER_SPEED (2 * KEY_DOWN_TIMER_SPEED)
+#define ENTRY_DELAY -90
+#define LINE_CLEAR_ANIMATION_FRAMES 30
+// the highest level a game can start on, the level select plus ten
+#define SIM_MAX_STARTING_LEVEL 19
+
+typedef enum {
+  KEY_DOWN_TIMER,
+  KEY_LEFT_TIMER,
+  KEY_RIGHT_TIMER,
+  KEY_TIMERS_COUNT,
+} KeyTimers;
+
+// bits of the input mask passed to SimStep, set while the button is held
+typedef enum {
+  INPUT_LEFT = 1 << 0,
+  INPUT_RIGHT = 1 << 1,
+  INPUT_DOWN = 1 << 2,
+  INPUT_ROTATE_CLOCKWISE = 1 << 3,
+  INPUT_ROTATE_COUNTER_CLOCKWISE = 1 << 4,
+} InputButton;
+
+// bits of SimState.events, raised by the SimStep that caused them
+typedef enum {
+  SIM_EVENT_LINECLEAR = 1 << 0,
+  SIM_EVENT_TETRIS = 1 << 1,
+  SIM_EVENT_GAMEOVER = 1 << 2,
+} SimEvent;
+
+// Everything the game rules need, plain data with no pointers or handles, so it can be copied freely.
+// The core keeps no global mutable state, so any number of SimStates can be stepped independently, from any thread.
+// All timers count frames, so a game is fully determined by its seed, starting level and input masks.
+typedef struct {
+  Board board;
+  // bit N is set while row N is full and waiting for the line clear animation to finish
+  uint32_t fullRows;
+  Piece currentPiece;
+  Piece nextPiece;
+  int fallingTimer;
+  int keyTimers[KEY_TIMERS_COUNT];
+  int ARETimer;
+  int animationTimer;
+  int linesCleared;
+  int startingLevel;
+  int currentLevel;
+  int score;
+  int softDropCounter;
+  int statistics[PIECE_COUNT];
+  Rng rng;
+  // Zobrist hash of the occupied cells and the current piece type, kept up to date on lock, line clear and spawn
+  uint64_t hash;
+  uint8_t previousInput;
+  uint8_t events;
+  bool isGameOver;
+} SimState;
+
+void SimReset(SimState *state, uint64_t seed);
+void SimStart(SimState *state, int startingLevel);
+void SimStep(SimState *state, uint8_t input);
+uint64_t SimComputeHash(const SimState *state);
+int SimGetLevel(int startingLevel, int linesCleared);
+int SimGetLineClearScore(int linesCleared, int level);
+int SimGetEntryDelay(int lockRow);
+int SimGetFramesUntilSpawn(const SimState *state);
+
+#endif // SIM_H
@@ -0,0 +1,63 @@
+#include <string.h>
+
+#include "snapshot.h"
+
+void SimSave(const SimState *state, SimSnapshot *snapshot) {
+  memcpy(snapshot->rows, state->board.rows, sizeof(snapshot->rows));
+  memcpy(snapshot->shapeTypes, state->board.shapeTypes, sizeof(snapshot->shapeTypes));
+  for (int i = 0; i < PIECE_COUNT; i++) {
+    snapshot->statistics[i] = state->statistics[i];
+  }
+  for (int i = 0; i < KEY_TIMERS_COUNT; i++) {
+    snapshot->keyTimers[i] = state->keyTimers[i];
+  }
+  snapshot->rng = state->rng.state;
+  snapshot->hash = state->hash;
+  snapshot->fullRows = state->fullRows;
+  snapshot->linesCleared = state->linesCleared;
+  snapshot->score = state->score;
+  snapshot->startingLevel = state->startingLevel;
+  snapshot->currentLevel = state->currentLevel;
+  snapshot->fallingTimer = state->fallingTimer;
+  snapshot->currentX = state->currentPiece.x;
+  snapshot->currentY = state->currentPiece.y;
+  snapshot->currentType = state->currentPiece.type;
+  snapshot->currentRotation = state->currentPiece.rotationIndex;
+  snapshot->nextType = state->nextPiece.type;
+  snapshot->ARETimer = state->ARETimer;
+  snapshot->animationTimer = state->animationTimer;
+  snapshot->softDropCounter = state->softDropCounter;
+  snapshot->previousInput = state->previousInput;
+  snapshot->events = state->events;
+  snapshot->isGameOver = state->isGameOver;
+}
+
+void SimRestore(SimState *state, const SimSnapshot *snapshot) {
+  memcpy(state->board.rows, snapshot->rows, sizeof(snapshot->rows));
+  memcpy(state->board.shapeTypes, snapshot->shapeTypes, sizeof(snapshot->shapeTypes));
+  for (int row = ROWS; row < ROWS + BOARD_FLOOR_ROWS; row++) {
+    state->board.rows[row] = BOARD_FULL_ROW;
+  }
+  for (int i = 0; i < PIECE_COUNT; i++) {
+    state->statistics[i] = snapshot->statistics[i];
+  }
+  for (int i = 0; i < KEY_TIMERS_COUNT; i++) {
+    state->keyTimers[i] = snapshot->keyTimers[i];
+  }
+  state->rng.state = snapshot->rng;
+  state->hash = snapshot->hash;
+  state->fullRows = snapshot->fullRows;
+  state->linesCleared = snapshot->linesCleared;
+  state->score = snapshot->score;
+  state->startingLevel = snapshot->startingLevel;
+  state->currentLevel = snapshot->currentLevel;
+  state->fallingTimer = snapshot->fallingTimer;
+  state->currentPiece = (Piece){snapshot->currentType, snapshot->currentX, snapshot->currentY, snapshot->currentRotation};
+  state->nextPiece = (Piece){snapshot->nextType, INITIAL_BOARD_X, INITIAL_BOARD_Y, INITIAL_ROTATION};
+  state->ARETimer = snapshot->ARETimer;
+  state->animationTimer = snapshot->animationTimer;
+  state->softDropCounter = snapshot->softDropCounter;
+  state->previousInput = snapshot->previousInput;
+  state->events = snapshot->events;
+  state->isGameOver = snapshot->isGameOver;
+}
@@ -0,0 +1,39 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+
+#include "sim.h"
+
+// A SimState squeezed into a fixed 208 bytes, for search, rollback and save states.
+// Saving and restoring is a handful of fixed-size copies, equal games always give byte-identical snapshots.
+typedef struct {
+  uint64_t rng;
+  uint64_t hash;
+  uint32_t shapeTypes[ROWS];
+  uint32_t fullRows;
+  uint32_t linesCleared;
+  int32_t score;
+  uint32_t statistics[PIECE_COUNT];
+  uint16_t rows[ROWS];
+  uint16_t startingLevel;
+  uint16_t currentLevel;
+  int16_t fallingTimer;
+  int8_t currentX;
+  int8_t currentY;
+  uint8_t currentType;
+  uint8_t currentRotation;
+  uint8_t nextType;
+  uint8_t keyTimers[KEY_TIMERS_COUNT];
+  uint8_t ARETimer;
+  uint8_t animationTimer;
+  uint8_t softDropCounter;
+  uint8_t previousInput;
+  uint8_t events;
+  uint8_t isGameOver;
+} SimSnapshot;
+
+void SimSave(const SimState *state, SimSnapshot *snapshot);
+void SimRestore(SimState *state, const SimSnapshot *snapshot);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,122 @@
+#include "tetromino.h"
+#include "util.h"
+
+#define CELL_MASK(X, Y, ROW) ((Y) == (ROW) ? 1 << (X) : 0)
+#define ROW_MASK(ROW, X0, Y0, X1, Y1, X2, Y2, X3, Y3)                                                                                      \
+  (CELL_MASK(X0, Y0, ROW) | CELL_MASK(X1, Y1, ROW) | CELL_MASK(X2, Y2, ROW) | CELL_MASK(X3, Y3, ROW))
+#define MIN4(A, B, C, D) MIN(MIN(A, B), MIN(C, D))
+#define MAX4(A, B, C, D) MAX(MAX(A, B), MAX(C, D))
+// Expands the four cells of a rotation into its cells, row masks and bounding box at compile time
+#define ROTATION(X0, Y0, X1, Y1, X2, Y2, X3, Y3)                                                                                           \
+  {{{X0, Y0}, {X1, Y1}, {X2, Y2}, {X3, Y3}},                                                                                               \
+   {ROW_MASK(0, X0, Y0, X1, Y1, X2, Y2, X3, Y3), ROW_MASK(1, X0, Y0, X1, Y1, X2, Y2, X3, Y3), ROW_MASK(2, X0, Y0, X1, Y1, X2, Y2, X3, Y3), \
+    ROW_MASK(3, X0, Y0, X1, Y1, X2, Y2, X3, Y3)},                                                                                          \
+   MIN4(X0, X1, X2, X3),                                                                                                                   \
+   MAX4(X0, X1, X2, X3),                                                                                                                   \
+   MIN4(Y0, Y1, Y2, Y3),                                                                                                                   \
+   MAX4(Y0, Y1, Y2, Y3)}
+
+const PieceType tetrominoes[] = {
+    // I
+    {{ROTATION(0, 2, 1, 2, 2, 2, 3, 2),
+      ROTATION(2, 0, 2, 1, 2, 2, 2, 3),
+      ROTATION(0, 2, 1, 2, 2, 2, 3, 2),
+      ROTATION(2, 0, 2, 1, 2, 2, 2, 3)},
+     0},
+    // J
+    {{ROTATION(1, 2, 2, 2, 3, 2, 3, 3),
+      ROTATION(1, 3, 2, 1, 2, 2, 2, 3),
+      ROTATION(1, 2, 2, 2, 3, 2, 1, 1),
+      ROTATION(3, 1, 2, 1, 2, 2, 2, 3)},
+     2},
+    // L
+    {{ROTATION(1, 2, 2, 2, 3, 2, 1, 3),
+      ROTATION(1, 1, 2, 1, 2, 2, 2, 3),
+      ROTATION(1, 2, 2, 2, 3, 2, 3, 1),
+      ROTATION(3, 3, 2, 1, 2, 2, 2, 3)},
+     1},
+    // O
+    {{ROTATION(1, 2, 1, 3, 2, 2, 2, 3),
+      ROTATION(1, 2, 1, 3, 2, 2, 2, 3),
+      ROTATION(1, 2, 1, 3, 2, 2, 2, 3),
+      ROTATION(1, 2, 1, 3, 2, 2, 2, 3)},
+     0},
+    // T
+    {{ROTATION(1, 2, 2, 2, 3, 2, 2, 3),
+      ROTATION(2, 1, 2, 2, 2, 3, 1, 2),
+      ROTATION(1, 2, 2, 2, 3, 2, 2, 1),
+      ROTATION(2, 1, 2, 2, 2, 3, 3, 2)},
+     0},
+    // S
+    {{ROTATION(2, 2, 2, 3, 3, 2, 1, 3),
+      ROTATION(2, 2, 2, 1, 3, 2, 3, 3),
+      ROTATION(2, 2, 2, 3, 3, 2, 1, 3),
+      ROTATION(2, 2, 2, 1, 3, 2, 3, 3)},
+     2},
+    // Z
+    {{ROTATION(2, 2, 2, 3, 3, 3, 1, 2),
+      ROTATION(2, 3, 2, 2, 3, 1, 3, 2),
+      ROTATION(2, 2, 2, 3, 3, 3, 1, 2),
+      ROTATION(2, 3, 2, 2, 3, 1, 3, 2)},
+     1},
+};
+
+// Branch-free: the four rows below y are always readable thanks to the floor padding, and every rotation has a cell in
+// columns 0..2 and in columns 2..3 of its 4x4 box, so any x outside [-BOARD_WALL_WIDTH, COLUMNS - 1] hits a wall no matter
+// what. Clamping x into that range keeps the shift inside the 16-bit row without changing the answer.
+// y is expected to be >= 0, pieces never move up.
+bool PieceFits(const Board *board, int type, int rotationIndex, int x, int y) {
+  const uint8_t *rowMasks = tetrominoes[type].rotations[rotationIndex].rowMasks;
+  const uint16_t *rows = &board->rows[CLAMP(y, 0, ROWS)];
+  const int shift = CLAMP(x, -BOARD_WALL_WIDTH, COLUMNS - 1) + BOARD_WALL_WIDTH;
+  const int overlap = (rows[0] & (rowMasks[0] << shift)) | (rows[1] & (rowMasks[1] << shift)) | (rows[2] & (rowMasks[2] << shift)) |
+                      (rows[3] & (rowMasks[3] << shift));
+  return overlap == 0;
+}
+
+void PieceRotateClockwise(Piece *piece, const Board *board) {
+  const int rotationIndex = (piece->rotationIndex + 1) % 4;
+  if (PieceFits(board, piece->type, rotationIndex, piece->x, piece->y)) {
+    piece->rotationIndex = rotationIndex;
+  }
+}
+
+void PieceRotateCounterClockwise(Piece *piece, const Board *board) {
+  const int rotationIndex = ((piece->rotationIndex - 1) + 4) % 4;
+  if (PieceFits(board, piece->type, rotationIndex, piece->x, piece->y)) {
+    piece->rotationIndex = rotationIndex;
+  }
+}
+
+void PieceMoveLeft(Piece *piece, const Board *board) {
+  piece->x -= PieceFits(board, piece->type, piece->rotationIndex, piece->x - 1, piece->y);
+}
+
+void PieceMoveRight(Piece *piece, const Board *board) {
+  piece->x += PieceFits(board, piece->type, piece->rotationIndex, piece->x + 1, piece->y);
+}
+
+bool PieceMoveDown(Piece *piece, const Board *board) {
+  const bool fits = PieceFits(board, piece->type, piece->rotationIndex, piece->x, piece->y + 1);
+  piece->y += fits;
+  return fits;
+}
+
+void PieceLock(const Piece *piece, Board *board) {
+  const PieceConfiguration *blocks = &tetrominoes[piece->type].rotations[piece->rotationIndex];
+  for (int i = 0; i < 4; i++) {
+    const int x = piece->x + blocks->cells[i].x;
+    const int y = piece->y + blocks->cells[i].y;
+    board->rows[y] |= BOARD_CELL(x);
+    board->shapeTypes[y] |= (uint32_t)tetrominoes[piece->type].shapeType << (BOARD_SHAPE_TYPE_BITS * x);
+  }
+}
+
+// Like the NES, rolls once more when the first roll repeats the previous piece, previousType is -1 for the very first piece
+Piece PieceGetRandom(Rng *rng, int previousType) {
+  int type = RngRange(rng, 0, PIECE_COUNT - 1);
+  if (type == previousType) {
+    type = RngRange(rng, 0, PIECE_COUNT - 1);
+  }
+  return (Piece){type, INITIAL_BOARD_X, INITIAL_BOARD_Y, INITIAL_ROTATION};
+}
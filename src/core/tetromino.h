@@ -0,0 +1,54 @@
+#ifndef TETROMINO_H
+#define TETROMINO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "board.h"
+#include "rng.h"
+
+#define PIECE_COUNT 7
+#define INITIAL_ROTATION 0
+#define INITIAL_BOARD_X 3
+#define INITIAL_BOARD_Y 0
+
+typedef struct {
+  int8_t x;
+  int8_t y;
+} PieceCell;
+
+typedef struct {
+  PieceCell cells[4];
+  // rowMasks[Y] has bit X set for every cell (X, Y), so shifting it by (x + BOARD_WALL_WIDTH) lines it up with the board rows
+  uint8_t rowMasks[4];
+  int8_t minX;
+  int8_t maxX;
+  int8_t minY;
+  int8_t maxY;
+} PieceConfiguration;
+
+typedef struct {
+  PieceConfiguration rotations[4];
+  int shapeType;
+} PieceType;
+
+typedef struct {
+  // index into tetrominoes
+  int type;
+  int x;
+  int y;
+  int rotationIndex;
+} Piece;
+
+void PieceRotateClockwise(Piece *piece, const Board *board);
+void PieceRotateCounterClockwise(Piece *piece, const Board *board);
+void PieceMoveLeft(Piece *piece, const Board *board);
+void PieceMoveRight(Piece *piece, const Board *board);
+bool PieceMoveDown(Piece *piece, const Board *board);
+bool PieceFits(const Board *board, int type, int rotationIndex, int x, int y);
+void PieceLock(const Piece *piece, Board *board);
+Piece PieceGetRandom(Rng *rng, int previousType);
+
+extern const PieceType tetrominoes[];
+
+#endif // TETROMINO_H
@@ -0,0 +1,32 @@
+#include "zobrist.h"
+
+// cells take keys [0, ROWS * COLUMNS), piece types come right after them
+static uint64_t ZobristKey(uint64_t index) {
+  uint64_t z = (index + 1) * 0x9E3779B97F4A7C15ull;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+uint64_t ZobristCell(int x, int y) { return ZobristKey((uint64_t)y * COLUMNS + x); }
+
+uint64_t ZobristPieceType(int type) { return ZobristKey((uint64_t)ROWS * COLUMNS + type); }
+
+// XOR of the keys of every occupied playfield cell in the row, walls are ignored
+uint64_t ZobristRow(int y, uint16_t row) {
+  uint32_t cells = (uint32_t)(row & ~BOARD_EMPTY_ROW) >> BOARD_WALL_WIDTH;
+  uint64_t hash = 0;
+  while (cells) {
+    hash ^= ZobristCell(__builtin_ctz(cells), y);
+    cells &= cells - 1;
+  }
+  return hash;
+}
+
+uint64_t ZobristBoard(const Board *board) {
+  uint64_t hash = 0;
+  for (int row = 0; row < ROWS; row++) {
+    hash ^= ZobristRow(row, board->rows[row]);
+  }
+  return hash;
+}
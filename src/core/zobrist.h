@@ -0,0 +1,14 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <stdint.h>
+
+#include "board.h"
+
+// Zobrist keys are derived from the key index on the fly, so there is no table to initialize or share between threads
+uint64_t ZobristCell(int x, int y);
+uint64_t ZobristRow(int y, uint16_t row);
+uint64_t ZobristPieceType(int type);
+uint64_t ZobristBoard(const Board *board);
+
+#endif // ZOBRIST_H
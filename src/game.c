@@ -1,30 +1,46 @@
 #include <raylib.h>
 #include <raymath.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
 
 #include "game.h"
 #include "piece.h"
-#include "util.h"
 
-static void GameDrawBoard(Block board[ROWS][COLUMNS], Vector2 screenPosition);
-static void GameReset(void);
-static void GameUpdateMusic(void);
-static void GameHandleInput(void);
-static int GameGetFullRowsCount(void);
-
-static const int scoringTable[4] = {40, 100, 300, 1200};
-static const float fallingSpeedTable[30] = {0.800f, 0.715f, 0.632f, 0.549f, 0.466f, 0.383f, 0.300f, 0.216f, 0.133f, 0.100f,
-                                            0.083f, 0.083f, 0.083f, 0.067f, 0.067f, 0.067f, 0.050f, 0.050f, 0.050f, 0.033f,
-                                            0.033f, 0.033f, 0.033f, 0.033f, 0.033f, 0.033f, 0.033f, 0.033f, 0.033f, 0.016f};
-static GameState state = {0};
+static void GameDrawBoard(const GameState *game, Vector2 screenPosition);
+static void GameReset(GameState *game);
+static void GameStartReplay(GameState *game);
+static void GameFinishReplay(GameState *game);
+static void GameUpdateMusic(GameState *game);
+static bool GameCreateAgent(GameState *game);
+
+static const KeyboardKey gameKeyCodes[GAME_KEY_COUNT] = {
+    [GAME_KEY_LEFT] = KEY_LEFT,
+    [GAME_KEY_RIGHT] = KEY_RIGHT,
+    [GAME_KEY_DOWN] = KEY_DOWN,
+    [GAME_KEY_ROTATE_CLOCKWISE] = KEY_X,
+    [GAME_KEY_ROTATE_COUNTER_CLOCKWISE] = KEY_Z,
+    [GAME_KEY_RESTART] = KEY_R,
+    [GAME_KEY_PAUSE] = KEY_SPACE,
+    [GAME_KEY_MUSIC] = KEY_M,
+    [GAME_KEY_BOT] = KEY_B,
+};
 
 // TODO: add max score
-void GameUpdate(void) {
-  switch (state.screenState) {
+// Handles the per-frame controls, then advances the simulation by `ticks` fixed frames with the held keys.
+// Keys pressed since the last tick are added to the first one, or carried over when this frame runs none.
+void GameUpdate(GameState *game, InputFrame input, int ticks) {
+  const uint8_t simInput = input.held & GAME_SIM_KEYS;
+  switch (game->screenState) {
   case SCREEN_START: {
+    if (game->isAutoplay) {
+      game->screenState = SCREEN_PLAY;
+      SimStart(&game->sim, game->autoplayLevel);
+      game->sim.previousInput = simInput;
+      GameStartReplay(game);
+      break;
+    }
     if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
       const float levelBoxSpacing = BLOCK_LEN / 4.0f;
       const float levelBoxLen = BLOCK_LEN * 1.5f;
@@ -33,155 +49,96 @@ void GameUpdate(void) {
       const Rectangle levelBox = {(WIDTH - totalWidth) / 2.0f + chosenLevel * (levelBoxLen + levelBoxSpacing), HEIGHT / 2.0f, levelBoxLen,
                                   levelBoxLen};
       if (chosenLevel >= 0 && chosenLevel <= 9 && CheckCollisionPointRec(GetMousePosition(), levelBox)) {
-        state.screenState = SCREEN_PLAY;
-        state.startingLevel = chosenLevel;
-        state.currentLevel = chosenLevel;
-        if (IsKeyDown(KEY_X)) {
-          state.startingLevel += 10;
-          state.currentLevel += 10;
-        }
+        game->screenState = SCREEN_PLAY;
+        SimStart(&game->sim, input.held & 1 << GAME_KEY_ROTATE_CLOCKWISE ? chosenLevel + 10 : chosenLevel);
+        // X is usually still held from picking the level, the first step shouldn't see it as a fresh press
+        game->sim.previousInput = simInput;
+        GameStartReplay(game);
       }
     }
     break;
   }
   case SCREEN_PLAY: {
     // State input Controls
-    if (IsKeyPressed(KEY_R)) {
-      GameReset();
-      break;
-    }
-    if (IsKeyPressed(KEY_SPACE)) {
-      state.isPaused = !state.isPaused;
-    }
-    if (IsKeyPressed(KEY_M)) {
-      state.isMusicPaused = !state.isMusicPaused;
-    }
-    if (state.isPaused) {
-      break;
-    }
-
-    GameUpdateMusic();
-    const float dt = GetFrameTime();
-    const float fallingSpeed = fallingSpeedTable[MIN(state.currentLevel, 29)];
-
-    if (state.ARETimer <= 0.0f) {
-      GameHandleInput();
-    }
-
-    if (state.fallingTimer < fallingSpeed) {
-      // FIXME: should this line be inside the condition or before it?
-      state.fallingTimer += dt;
-      break;
-    }
-
-    // Dropping Logic
-    const bool isDropped = PieceMoveDown(&state.currentPiece, state.board);
-    if (isDropped) {
-      state.fallingTimer = 0.0f;
+    if (input.pressed & 1 << GAME_KEY_RESTART) {
+      GameReset(game);
       break;
     }
-
-    // Locking Logic
-    int lockRow = -1;
-    for (int i = 0; i < 4; i++) {
-      const PieceConfiguration *blocks = &state.currentPiece.tetromino->rotations[state.currentPiece.rotationIndex];
-      const Vector2 blockPosition = Vector2Add(blocks->points[i], state.currentPiece.position);
-      lockRow = MAX(lockRow, (int)blockPosition.y);
+    if (input.pressed & 1 << GAME_KEY_PAUSE) {
+      game->isPaused = !game->isPaused;
     }
-    const float AREDelay = (int)(((((ROWS - lockRow - 1) + 2) / 4) * 2 + 10)) / 60.0f;
-    if (state.ARETimer < AREDelay) {
-      state.ARETimer += dt;
-      break;
+    if (input.pressed & 1 << GAME_KEY_MUSIC) {
+      game->isMusicPaused = !game->isMusicPaused;
     }
-
-    // Clear rows and update score and generate next piece
-    for (int i = 0; i < 4; i++) {
-      const PieceConfiguration *blocks = &state.currentPiece.tetromino->rotations[state.currentPiece.rotationIndex];
-      Vector2 blockPosition = Vector2Add(blocks->points[i], state.currentPiece.position);
-      state.board[(int)blockPosition.y][(int)blockPosition.x] = (Block){state.currentPiece.tetromino->shapeType, true};
+    if (input.pressed & 1 << GAME_KEY_BOT && GameCreateAgent(game)) {
+      game->isBotPlaying = !game->isBotPlaying;
+      AgentReset(game->agent);
     }
-
-    int fullRowsCount = GameGetFullRowsCount();
-    if (state.animationTimer <= 0.5f && fullRowsCount > 0) {
-      if (FloatEquals(state.animationTimer, 0)) {
-        if (fullRowsCount == 4) {
-          PlaySound(state.sounds[SOUND_TETRIS]);
-        } else {
-          PlaySound(state.sounds[SOUND_LINECLEAR]);
-        }
-      }
-      state.animationTimer += dt;
+    if (game->isPaused) {
+      game->tappedInput = 0;
       break;
     }
 
-    // Clear full rows
-    for (int row = 0; row < ROWS; row++) {
-      bool isFull = true;
-      for (int column = 0; column < COLUMNS; column++) {
-        if (!state.board[row][column].occupied) {
-          isFull = false;
-          break;
-        }
+    GameUpdateMusic(game);
+    game->tappedInput |= input.pressed & GAME_SIM_KEYS;
+    for (int i = 0; i < ticks && game->screenState == SCREEN_PLAY; i++) {
+      const uint8_t stepInput = game->isBotPlaying ? AgentGetInput(game->agent, &game->sim) : simInput | game->tappedInput;
+      game->tappedInput = 0;
+      SimStep(&game->sim, stepInput);
+      if (game->replay) {
+        ReplayWriterAdd(game->replay, stepInput, &game->sim);
       }
-      if (isFull) {
-        for (int column = 0; column < COLUMNS; column++) {
-          state.board[row][column].occupied = false;
-        }
-
-        for (int rowAbove = row; rowAbove > 0; rowAbove--) {
-          for (int column = 0; column < COLUMNS; column++) {
-            state.board[rowAbove][column] = state.board[rowAbove - 1][column];
-          }
-        }
+      if (game->sim.events & SIM_EVENT_TETRIS) {
+        PlaySound(game->sounds[SOUND_TETRIS]);
       }
-    }
-
-    // Update score and lines cleared
-    if (fullRowsCount > 0) {
-      state.linesCleared += fullRowsCount;
-      const int transitionPoint = (state.startingLevel + 1) * 10;
-      if (state.linesCleared >= transitionPoint) {
-        state.currentLevel = (state.linesCleared - transitionPoint) / 10 + state.startingLevel + 1;
+      if (game->sim.events & SIM_EVENT_LINECLEAR) {
+        PlaySound(game->sounds[SOUND_LINECLEAR]);
       }
-      state.score += scoringTable[fullRowsCount - 1] * (state.currentLevel + 1);
-    }
-
-    // Check if player lost
-    for (int i = 0; i < 4; i++) {
-      const PieceConfiguration *blocks = &state.nextPiece.tetromino->rotations[state.nextPiece.rotationIndex];
-      const Vector2 blockPosition = Vector2Add(blocks->points[i], INITIAL_BOARD_POSITION);
-      if (state.board[(int)blockPosition.y][(int)blockPosition.x].occupied) {
-        PlaySound(state.sounds[SOUND_GAMEOVER]);
-        state.screenState = SCREEN_GAMEOVER;
-        break;
+      if (game->sim.events & SIM_EVENT_GAMEOVER) {
+        PlaySound(game->sounds[SOUND_GAMEOVER]);
+        game->screenState = SCREEN_GAMEOVER;
+        GameFinishReplay(game);
       }
     }
-
-    // Generate next piece
-    state.score += MAX(0, state.softDropCounter - 1);
-    state.softDropCounter = 0;
-    state.fallingTimer = 0.0f;
-    state.ARETimer = 0.0f;
-    state.animationTimer = 0.0f;
-    state.currentPiece = state.nextPiece;
-    state.statistics[(state.currentPiece.tetromino - tetrominoes)]++;
-    state.currentPiece.position = INITIAL_BOARD_POSITION;
-    state.nextPiece = PieceGetRandom(state.currentPiece.tetromino);
-    state.keyTimers[KEY_DOWN_TIMER] = KEY_DOWN_TIMER_SPEED + 1.0f;
     break;
   }
   case SCREEN_GAMEOVER:
-    if (IsKeyPressed(KEY_R)) {
-      GameReset();
+    if (input.pressed & 1 << GAME_KEY_RESTART) {
+      GameReset(game);
     }
     break;
   }
 }
 
-void GameDraw(void) {
+// Every key queried once. IsKeyPressed misses a key that went down and up again within the frame, raylib's queue of pressed keys
+// doesn't, so it's drained too.
+InputFrame GameReadKeyboard(void) {
+  InputFrame input = {0};
+  for (int key = 0; key < GAME_KEY_COUNT; key++) {
+    input.held |= IsKeyDown(gameKeyCodes[key]) << key;
+    input.pressed |= IsKeyPressed(gameKeyCodes[key]) << key;
+  }
+  for (int code = GetKeyPressed(); code != 0; code = GetKeyPressed()) {
+    for (int key = 0; key < GAME_KEY_COUNT; key++) {
+      input.pressed |= (code == (int)gameKeyCodes[key]) << key;
+    }
+  }
+  return input;
+}
+
+// For key sources that only know what's held, a press is a key that wasn't held the tick before
+InputFrame GameGetInputFrame(uint16_t held, uint16_t previousHeld) { return (InputFrame){held, held & ~previousHeld}; }
+
+void GameDraw(const GameState *game) {
   BeginDrawing();
   ClearBackground(BLACK);
-  switch (state.screenState) {
+  GameDrawScreen(game);
+  EndDrawing();
+}
+
+// The current screen, for callers that draw more on top within their own BeginDrawing/EndDrawing
+void GameDrawScreen(const GameState *game) {
+  switch (game->screenState) {
   case SCREEN_START: {
     const char *startText = "Select level to start";
     const Vector2 startTextMeasure = MeasureTextEx(GetFontDefault(), startText, FONT_SIZE_LARGE, FONT_SIZE_LARGE / 10.0f);
@@ -214,18 +171,18 @@ void GameDraw(void) {
                                      shownPlayfield.width + 2.0 * LINE_THICKNESS, shownPlayfield.height + LINE_THICKNESS},
                          LINE_THICKNESS, GRAY);
     BeginScissorMode(shownPlayfield.x, shownPlayfield.y, shownPlayfield.width, shownPlayfield.height);
-    PieceDraw(&state.currentPiece, (Vector2){playfield.x, playfield.y}, state.currentLevel % 10, 1);
-    GameDrawBoard(state.board, (Vector2){playfield.x, playfield.y});
+    PieceDraw(&game->sim.currentPiece, (Vector2){playfield.x, playfield.y}, game->sim.currentLevel % 10, 1);
+    GameDrawBoard(game, (Vector2){playfield.x, playfield.y});
     EndScissorMode();
 
     const Rectangle nextPieceRect = {shownPlayfield.x + shownPlayfield.width, HEIGHT / 3.0f, BLOCK_LEN * 5.0f, BLOCK_LEN * 4.0f};
-    PieceDraw(&state.nextPiece, (Vector2){nextPieceRect.x, nextPieceRect.y}, state.currentLevel % 10, 1);
+    PieceDrawPreview(game->sim.nextPiece.type, (Vector2){nextPieceRect.x, nextPieceRect.y}, game->sim.currentLevel % 10, 1);
     DrawRectangleLinesEx(nextPieceRect, LINE_THICKNESS, GRAY);
 
     const Rectangle linesCounterRect = {playfield.x - LINE_THICKNESS, playfield.y, shownPlayfield.width + 2.0f * LINE_THICKNESS,
                                         2.0f * BLOCK_LEN};
     DrawRectangleLinesEx(linesCounterRect, LINE_THICKNESS, GRAY);
-    const char *clearedLinesSting = TextFormat("LINES-%d", state.linesCleared);
+    const char *clearedLinesSting = TextFormat("LINES-%d", game->sim.linesCleared);
     const Vector2 clearedLinesStringMeasure = MeasureTextEx(GetFontDefault(), clearedLinesSting, FONT_SIZE_LARGE, FONT_SIZE_LARGE / 10.0f);
     DrawText(clearedLinesSting, linesCounterRect.x + (linesCounterRect.width - clearedLinesStringMeasure.x) / 2.0f,
              linesCounterRect.y + (linesCounterRect.height - clearedLinesStringMeasure.y) / 2.0f, FONT_SIZE_LARGE, WHITE);
@@ -234,7 +191,7 @@ void GameDraw(void) {
     DrawRectangleLinesEx(levelRect, LINE_THICKNESS, GRAY);
     DrawText("LEVEL", levelRect.x + (levelRect.width - MeasureText("LEVEL", FONT_SIZE_MEDIUM)) / 2.0f, levelRect.y + 5.0f, FONT_SIZE_MEDIUM,
              WHITE);
-    const char *currentLevelString = TextFormat("%d", state.currentLevel);
+    const char *currentLevelString = TextFormat("%d", game->sim.currentLevel);
     DrawText(currentLevelString, levelRect.x + (levelRect.width - MeasureText(currentLevelString, FONT_SIZE_MEDIUM)) / 2.0f,
              levelRect.y + BLOCK_LEN + 5.0f, FONT_SIZE_MEDIUM, WHITE);
 
@@ -243,7 +200,7 @@ void GameDraw(void) {
     DrawRectangleLinesEx(scoreRect, LINE_THICKNESS, GRAY);
     DrawText("SCORE", scoreRect.x + (scoreRect.width - MeasureText("SCORE", FONT_SIZE_MEDIUM)) / 2.0f, scoreRect.y + 5.0f, FONT_SIZE_MEDIUM,
              WHITE);
-    const char *scoreString = TextFormat("%09d", state.score);
+    const char *scoreString = TextFormat("%09d", game->sim.score);
     const Vector2 scoreStringMeasure = MeasureTextEx(GetFontDefault(), scoreString, FONT_SIZE_MEDIUM, FONT_SIZE_MEDIUM / 10.0f);
     DrawText(scoreString, scoreRect.x + (scoreRect.width - scoreStringMeasure.x) / 2.0f, scoreRect.y + BLOCK_LEN + 5.0f, FONT_SIZE_MEDIUM,
              WHITE);
@@ -258,24 +215,17 @@ void GameDraw(void) {
              FONT_SIZE_SMALL, WHITE);
 
     for (int i = 0; i < PIECE_COUNT; i++) {
-      Piece piece = {&tetrominoes[i], tetrominoes[i].displayOffset, INITIAL_ROTATION};
-      PieceDraw(&piece, (Vector2){statisticsRect.x + 10.0f, statisticsRect.y + (3 * BLOCK_LEN * 0.6f) * i + BLOCK_LEN * 0.6},
-                state.currentLevel % 10, 0.6f);
-      DrawText(TextFormat("%03d", state.statistics[i]), statisticsRect.x + 5 * BLOCK_LEN * 0.7f,
+      PieceDrawPreview(i,
+                       (Vector2){statisticsRect.x + 10.0f, statisticsRect.y + (3 * BLOCK_LEN * 0.6f) * i + BLOCK_LEN * 0.6},
+                       game->sim.currentLevel % 10, 0.6f);
+      DrawText(TextFormat("%03d", game->sim.statistics[i]), statisticsRect.x + 5 * BLOCK_LEN * 0.7f,
                statisticsRect.y + (3 * BLOCK_LEN * 0.6f) * (i) + 1.4 * BLOCK_LEN, FONT_SIZE_SMALL, WHITE);
     }
 
-    if (GameGetFullRowsCount() > 0) {
+    if (game->sim.fullRows) {
       for (int row = 0; row < ROWS; row++) {
-        bool isFull = true;
-        for (int column = 0; column < COLUMNS; column++) {
-          if (!state.board[row][column].occupied) {
-            isFull = false;
-            break;
-          }
-        }
-        if (isFull) {
-          int w = ((int)(state.animationTimer * 10) + 1) * BLOCK_LEN;
+        if (game->sim.fullRows & (1u << row)) {
+          int w = (game->sim.animationTimer / 6 + 1) * BLOCK_LEN;
           DrawRectangle(playfield.x + (5 * BLOCK_LEN - w), playfield.y + row * BLOCK_LEN, w, BLOCK_LEN, BLACK);
           DrawRectangle(playfield.x + 5 * BLOCK_LEN, playfield.y + row * BLOCK_LEN, w, BLOCK_LEN, BLACK);
         }
@@ -283,7 +233,7 @@ void GameDraw(void) {
     }
 
     // TODO: Maybe refactor this into its own function?
-    if (state.screenState == SCREEN_PLAY) {
+    if (game->screenState == SCREEN_PLAY) {
       break;
     }
     const char *gameoverString = "GAME OVER";
@@ -302,141 +252,125 @@ void GameDraw(void) {
     break;
   }
   }
-
-  EndDrawing();
 }
 
-void GameInit(void) {
+void GameInit(GameState *game) {
   for (int i = 0; i < MUSIC_COUNT; i++) {
-    state.music[i] = LoadMusicStream(TextFormat("resources/Music_%d.ogg", i + 1));
-    if (!IsMusicValid(state.music[i])) {
+    game->music[i] = LoadMusicStream(TextFormat("resources/Music_%d.ogg", i + 1));
+    if (!IsMusicValid(game->music[i])) {
       fprintf(stderr, "Coudln't load file: `resources/Music_%d.ogg`", i + 1);
       exit(1);
     }
-    state.music[i].looping = false;
-    SetMusicVolume(state.music[i], 0.05f);
+    game->music[i].looping = false;
+    SetMusicVolume(game->music[i], 0.05f);
   }
   for (int i = 0; i < SOUND_COUNT; i++) {
-    state.sounds[i] = LoadSound(TextFormat("resources/Sound_%d.ogg", i + 1));
-    if (!IsSoundValid(state.sounds[i])) {
+    game->sounds[i] = LoadSound(TextFormat("resources/Sound_%d.ogg", i + 1));
+    if (!IsSoundValid(game->sounds[i])) {
       fprintf(stderr, "Coudln't load file: `resources/Sound_%d.ogg`", i + 1);
       exit(1);
     }
   }
-  state.currentMusicIndex = 0;
-  PlayMusicStream(state.music[state.currentMusicIndex]);
-  GameReset();
+  if (game->isAutoplay) {
+    GameCreateAgent(game);
+  }
+  game->currentMusicIndex = 0;
+  PlayMusicStream(game->music[game->currentMusicIndex]);
+  GameReset(game);
 }
 
-void GameCleanup(void) {
+void GameCleanup(GameState *game) {
   for (int i = 0; i < MUSIC_COUNT; i++) {
-    UnloadMusicStream(state.music[i]);
+    UnloadMusicStream(game->music[i]);
   }
+  if (game->agent && AgentGetStats(game->agent)->plans > 0) {
+    const AgentStats *stats = AgentGetStats(game->agent);
+    printf("bot: %ld of %ld plans came late, %ld frames waited on them\n", stats->latePlans, stats->plans, stats->lateFrames);
+    printf("bot: plans by depth searched:");
+    for (int depth = 1; depth <= BOT_MAX_DEPTH; depth++) {
+      printf(" %d:%ld", depth, stats->depthCounts[depth]);
+    }
+    printf(", %.0f nodes per plan\n", (double)stats->nodes / stats->plans);
+  }
+  AgentDestroy(game->agent);
+  GameFinishReplay(game);
 }
 
-static void GameUpdateMusic(void) {
-  Music currentMusic = state.music[state.currentMusicIndex];
-  if (state.isMusicPaused) {
+static void GameUpdateMusic(GameState *game) {
+  Music currentMusic = game->music[game->currentMusicIndex];
+  if (game->isMusicPaused) {
     return;
   }
   UpdateMusicStream(currentMusic);
   if (!IsMusicStreamPlaying(currentMusic)) {
-    state.currentMusicIndex = (state.currentMusicIndex + 1) % MUSIC_COUNT;
-    PlayMusicStream(state.music[state.currentMusicIndex]);
+    game->currentMusicIndex = (game->currentMusicIndex + 1) % MUSIC_COUNT;
+    PlayMusicStream(game->music[game->currentMusicIndex]);
   }
-  state.isMusicPaused = false;
+  game->isMusicPaused = false;
 }
 
-static void GameHandleInput(void) {
-  const float dt = GetFrameTime();
-  if (IsKeyPressed(KEY_X)) {
-    PieceRotateClockwise(&state.currentPiece, state.board);
-  }
-  if (IsKeyPressed(KEY_Z)) {
-    PieceRotateCounterClockwise(&state.currentPiece, state.board);
-  }
-  if (IsKeyDown(KEY_LEFT)) {
-    if (WithinHalf(state.keyTimers[KEY_LEFT_TIMER], KEY_TIMER_SPEED) || IsKeyPressed(KEY_LEFT)) {
-      state.keyTimers[KEY_LEFT_TIMER] = 0.0f;
-      PieceMoveLeft(&state.currentPiece, state.board);
-    } else if (state.keyTimers[KEY_LEFT_TIMER] < KEY_TIMER_SPEED) {
-      state.keyTimers[KEY_LEFT_TIMER] += dt;
-    }
-  } else {
-    state.keyTimers[KEY_LEFT_TIMER] = 0.0f;
-  }
-  if (IsKeyDown(KEY_RIGHT)) {
-    if (WithinHalf(state.keyTimers[KEY_RIGHT_TIMER], KEY_TIMER_SPEED) || IsKeyPressed(KEY_RIGHT)) {
-      state.keyTimers[KEY_RIGHT_TIMER] = 0.0f;
-      PieceMoveRight(&state.currentPiece, state.board);
-    } else if (state.keyTimers[KEY_RIGHT_TIMER] < KEY_TIMER_SPEED) {
-      state.keyTimers[KEY_RIGHT_TIMER] += dt;
-    }
-  } else {
-    state.keyTimers[KEY_RIGHT_TIMER] = 0.0f;
+static void GameReset(GameState *game) {
+  // a game restarted halfway is kept too, without the game over flag
+  GameFinishReplay(game);
+  game->seed = (uint64_t)GetRandomValue(0, INT_MAX) << 32 | (uint32_t)GetRandomValue(0, INT_MAX);
+  SimReset(&game->sim, game->seed);
+  game->screenState = SCREEN_START;
+  game->isPaused = false;
+  game->tappedInput = 0;
+  if (game->agent) {
+    AgentReset(game->agent);
   }
+}
 
-  const float fallingSpeed = fallingSpeedTable[MIN(state.currentLevel, 29)];
-  if (IsKeyDown(KEY_DOWN)) {
-    if (WithinHalf(state.keyTimers[KEY_DOWN_TIMER], KEY_DOWN_TIMER_SPEED) || IsKeyPressed(KEY_DOWN)) {
-      state.fallingTimer = fallingSpeed;
-      state.softDropCounter++;
-      state.keyTimers[KEY_DOWN_TIMER] = 0.0f;
-    } else if (state.keyTimers[KEY_DOWN_TIMER] < KEY_DOWN_TIMER_SPEED) {
-      state.keyTimers[KEY_DOWN_TIMER] += dt;
+static void GameStartReplay(GameState *game) {
+  if (!game->replayDirectory) {
+    return;
+  }
+  const char *path = TextFormat("%s/%016llx.rep", game->replayDirectory, (unsigned long long)game->seed);
+  game->replayFile = fopen(path, "wb");
+  game->replay = game->replayFile ? ReplayWriterCreate(game->replayFile, game->seed, &game->sim, REPLAY_KEYFRAME_INTERVAL) : NULL;
+  if (!game->replay) {
+    fprintf(stderr, "couldn't record the game to %s\n", path);
+    if (game->replayFile) {
+      fclose(game->replayFile);
+      game->replayFile = NULL;
     }
-  } else {
-    state.keyTimers[KEY_DOWN_TIMER] = 0.0f;
-    state.softDropCounter = 0;
   }
 }
 
-static void GameReset(void) {
-  for (int i = 0; i < ROWS * COLUMNS; i++) {
-    ((Block *)state.board)[i] = (Block){0, false};
-  }
-  for (int i = 0; i < KEY_TIMERS_COUNT; i++) {
-    state.keyTimers[i] = 0.0f;
+static void GameFinishReplay(GameState *game) {
+  if (!game->replay) {
+    return;
   }
-  for (int i = 0; i < PIECE_COUNT; i++) {
-    state.statistics[i] = 0;
+  if (!ReplayWriterFinish(game->replay, &game->sim) | (fclose(game->replayFile) != 0)) {
+    fprintf(stderr, "couldn't finish writing the replay of game %016llx\n", (unsigned long long)game->seed);
   }
-  state.screenState = SCREEN_START;
-  state.startingLevel = 0;
-  state.currentLevel = 0;
-  state.score = 0;
-  state.isPaused = false;
-  state.currentPiece = PieceGetRandom(NULL);
-  state.statistics[(state.currentPiece.tetromino - tetrominoes)]++;
-  state.currentPiece.position = INITIAL_BOARD_POSITION;
-  state.nextPiece = PieceGetRandom(state.currentPiece.tetromino);
-  state.fallingTimer = ENTRY_DELAY;
-  state.linesCleared = 0;
-  state.ARETimer = 0.0f;
-  state.animationTimer = 0.0f;
+  game->replay = NULL;
+  game->replayFile = NULL;
 }
 
-static void GameDrawBoard(Block board[ROWS][COLUMNS], Vector2 screenPosition) {
+static void GameDrawBoard(const GameState *game, Vector2 screenPosition) {
+  const Board *board = &game->sim.board;
   for (int y = 0; y < ROWS; y++) {
     for (int x = 0; x < COLUMNS; x++) {
-      if (board[y][x].occupied) {
+      if (board->rows[y] & BOARD_CELL(x)) {
         const Vector2 blockPositionOnScreen = Vector2Add(Vector2Scale((Vector2){x, y}, BLOCK_LEN), screenPosition);
-        PieceDrawBlock(blockPositionOnScreen, state.currentLevel % 10, board[y][x].shapeType, 1);
+        PieceDrawBlock(blockPositionOnScreen, game->sim.currentLevel % 10, BOARD_SHAPE_TYPE(board, x, y), 1);
       }
     }
   }
 }
 
-static int GameGetFullRowsCount(void) {
-  int clearedRows = 0;
-  for (int row = 0; row < ROWS; row++) {
-    for (int column = 0; column < COLUMNS; column++) {
-      if (!state.board[row][column].occupied) {
-        goto continue_outer;
-      }
-    }
-    clearedRows++;
-  continue_outer: {}
+// The bot's threads and transposition table wait until it's wanted, a player who never presses B doesn't pay for them
+static bool GameCreateAgent(GameState *game) {
+  if (game->agent) {
+    return true;
+  }
+  BotConfig config = botDefaultConfig;
+  config.threadCount = game->isAutoplay ? 0 : GAME_BOT_THREADS;
+  game->agent = AgentCreate(&config);
+  if (!game->agent) {
+    fprintf(stderr, "Couldn't create the bot, playing without it\n");
   }
-  return clearedRows;
+  return game->agent != NULL;
 }
@@ -3,33 +3,24 @@
 
 #include <raylib.h>
 
+#include "bot/agent.h"
+#include "core/replay.h"
+#include "core/sim.h"
+
 #define WIDTH 1000
 #define HEIGHT 1000
 #define BLOCK_LEN 40
 #define BLOCK_SIZE ((Vector2){BLOCK_LEN, BLOCK_LEN})
-#define BUFFER_ROWS 2
 #define BUFFER_AREA (BUFFER_ROWS * BLOCK_LEN)
-#define PLAYFIELD_ROWS 20
-#define ROWS (BUFFER_ROWS + PLAYFIELD_ROWS)
-#define COLUMNS 10
-#define PIECE_COUNT 7
-#define INITIAL_ROTATION 0
-#define INITIAL_BOARD_POSITION ((Vector2){3, 0})
 #define FONT_SIZE_LARGE 60.0
 #define FONT_SIZE_MEDIUM 40.0
 #define FONT_SIZE_SMALL 30.0
-#define KEY_DOWN_TIMER_SPEED 0.03333f
-#define KEY_TIMER_SPEED (2 * KEY_DOWN_TIMER_SPEED)
-#define ENTRY_DELAY -1.5f
 #define LINE_THICKNESS 2.0f
+// search threads for the bot a player turns on with B, autoplay uses every core
+#define GAME_BOT_THREADS 2
 #define MUSIC_COUNT 3
-
-typedef enum {
-  KEY_DOWN_TIMER,
-  KEY_LEFT_TIMER,
-  KEY_RIGHT_TIMER,
-  KEY_TIMERS_COUNT,
-} KeyTimers;
+// when rendering falls behind, drop the time beyond this many ticks instead of trying to catch up
+#define MAX_TICKS_PER_FRAME 8
 
 typedef enum {
   SCREEN_START,
@@ -37,6 +28,31 @@ typedef enum {
   SCREEN_GAMEOVER,
 } ScreenState;
 
+// Every key the game reads, so autoplay can stand in for the keyboard.
+// The first five are in the same order as the InputButton bits, so the low bits of a key mask are a SimStep input mask.
+typedef enum {
+  GAME_KEY_LEFT,
+  GAME_KEY_RIGHT,
+  GAME_KEY_DOWN,
+  GAME_KEY_ROTATE_CLOCKWISE,
+  GAME_KEY_ROTATE_COUNTER_CLOCKWISE,
+  GAME_KEY_RESTART,
+  GAME_KEY_PAUSE,
+  GAME_KEY_MUSIC,
+  GAME_KEY_BOT,
+  GAME_KEY_COUNT,
+} GameKey;
+
+#define GAME_SIM_KEYS ((1 << GAME_KEY_RESTART) - 1)
+
+// The keys since the last GameUpdate, bit N for GameKey N. It's gathered once and handed to GameUpdate, so anything standing in for
+// the keyboard (autoplay, a replay, a remote player) only has to fill in 4 bytes.
+typedef struct {
+  uint16_t held;
+  // went down since the last InputFrame, including keys that are already up again
+  uint16_t pressed;
+} InputFrame;
+
 typedef enum {
   SOUND_GAMEOVER,
   SOUND_LINECLEAR,
@@ -45,54 +61,34 @@ typedef enum {
 } SOUNDS;
 
 typedef struct {
-  Vector2 points[4];
-} PieceConfiguration;
-
-typedef struct {
-  PieceConfiguration rotations[4];
-  // the offset required so that the piece is centered when displayed on the "next piece" rectangle
-  Vector2 displayOffset;
-  int shapeType;
-} PieceType;
-
-typedef struct {
-  const PieceType *tetromino;
-  Vector2 position;
-  int rotationIndex;
-} Piece;
-
-typedef struct {
-  int shapeType;
-  bool occupied;
-} Block;
-
-typedef struct {
-  Block board[ROWS][COLUMNS];
+  SimState sim;
+  uint64_t seed;
+  // with a replayDirectory every game is recorded there as <seed>.rep
+  const char *replayDirectory;
+  FILE *replayFile;
+  ReplayWriter *replay;
+  // the bot, searching on its own thread, created the first time it plays
+  Agent *agent;
   ScreenState screenState;
-  Piece currentPiece;
-  Piece nextPiece;
-  float fallingTimer;
-  float keyTimers[KEY_TIMERS_COUNT];
-  float ARETimer;
-  float animationTimer;
-  int linesCleared;
-  int startingLevel;
-  int currentLevel;
-  int score;
-  int softDropCounter;
   Music music[MUSIC_COUNT];
   Sound sounds[SOUND_COUNT];
   int currentMusicIndex;
-  int statistics[7];
   bool isPaused;
   bool isMusicPaused;
+  bool isBotPlaying;
+  // sim keys pressed since the last tick, added to the next tick's input so a tap between two ticks still lands
+  uint8_t tappedInput;
+  // autoplay starts at autoplayLevel without the level select, its keys come from the bot
+  bool isAutoplay;
+  int autoplayLevel;
 } GameState;
 
-void GameCleanup(void);
-void GameInit(void);
-void GameUpdate(void);
-void GameDraw(void);
-
-extern const PieceType tetrominoes[];
+void GameCleanup(GameState *game);
+void GameInit(GameState *game);
+InputFrame GameReadKeyboard(void);
+InputFrame GameGetInputFrame(uint16_t held, uint16_t previousHeld);
+void GameUpdate(GameState *game, InputFrame input, int ticks);
+void GameDraw(const GameState *game);
+void GameDrawScreen(const GameState *game);
 
 #endif // GAME_H
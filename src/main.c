@@ -1,38 +1,240 @@
 #include <raylib.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #if defined(PLATFORM_WEB)
 #include <emscripten/emscripten.h>
 #endif
 
 #include "game.h"
+#include "viewer.h"
 
-static void UpdateDrawFrame(void);
+// GameDraw times are bucketed by this many microseconds for the percentiles, the last bucket takes everything slower
+#define DRAW_TIMING_BUCKET_US 50
+#define DRAW_TIMING_BUCKETS 2000
+#define DRAW_TIMING_REPORT_SECONDS 10.0
 
-int main(void) {
+typedef struct {
+  long count;
+  double totalSeconds;
+  double maxSeconds;
+  long buckets[DRAW_TIMING_BUCKETS];
+} DrawTimings;
+
+typedef struct {
+  GameState game;
+  // real time not yet consumed by fixed simulation ticks
+  double accumulator;
+} MainLoop;
+
+typedef struct {
+  int renderEvery;
+  long frameLimit;
+  long frames;
+  long games;
+  // the keys the bot held on the last tick
+  uint16_t keys;
+  DrawTimings timings;
+} Autoplay;
+
+static void UpdateDrawFrame(void *loop);
+static bool ParseNumber(const char *text, long min, long max, long *value);
+#if !defined(PLATFORM_WEB)
+static void AutoplayRun(MainLoop *loop, Autoplay *autoplay);
+static void ViewerRun(GameState *game, const char *path);
+static uint16_t AutoplayGetKeys(const GameState *game, uint16_t previousKeys);
+static void DrawTimingsAdd(DrawTimings *timings, double seconds);
+static void DrawTimingsReport(const DrawTimings *timings, const Autoplay *autoplay, const AgentStats *stats, double elapsed);
+#endif
+
+int main(int argc, char **argv) {
   SetTraceLogLevel(LOG_WARNING);
 
+  static MainLoop loop = {0};
+  static Autoplay autoplay = {.renderEvery = 100};
+  const char *replayPath = NULL;
+  bool isUsage = false;
+  for (int i = 1; i < argc && !isUsage; i++) {
+    if (strcmp(argv[i], "--autoplay") == 0) {
+      loop.game.isAutoplay = true;
+    } else if (strcmp(argv[i], "--render-every") == 0 && i + 1 < argc) {
+      long renderEvery;
+      isUsage = !ParseNumber(argv[++i], 1, INT_MAX, &renderEvery);
+      autoplay.renderEvery = renderEvery;
+    } else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc) {
+      long level;
+      isUsage = !ParseNumber(argv[++i], 0, SIM_MAX_STARTING_LEVEL, &level);
+      loop.game.autoplayLevel = level;
+    } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+      isUsage = !ParseNumber(argv[++i], 1, LONG_MAX, &autoplay.frameLimit);
+    } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+      loop.game.replayDirectory = argv[++i];
+    } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+      replayPath = argv[++i];
+    } else {
+      isUsage = true;
+    }
+  }
+  if (isUsage) {
+    fprintf(stderr, "usage: %s [--record DIR] [--replay FILE] [--autoplay [--render-every N] [--level 0-%d] [--frames N]]\n", argv[0],
+            SIM_MAX_STARTING_LEVEL);
+    return 1;
+  }
+
   InitAudioDevice();
   InitWindow(WIDTH, HEIGHT, "Tetris");
-  GameInit();
+  GameInit(&loop.game);
 
 #if defined(PLATFORM_WEB)
-  emscripten_set_main_loop(UpdateDrawFrame, 0, 1);
+  // no files to replay on the web
+  (void)replayPath;
+  emscripten_set_main_loop_arg(UpdateDrawFrame, &loop, 0, 1);
 #else
-  SetTargetFPS(120);
-  while (!WindowShouldClose()) {
-    UpdateDrawFrame();
+  if (replayPath) {
+    ViewerRun(&loop.game, replayPath);
+  } else if (loop.game.isAutoplay && loop.game.agent) {
+    AutoplayRun(&loop, &autoplay);
+  } else {
+    SetTargetFPS(120);
+    while (!WindowShouldClose()) {
+      UpdateDrawFrame(&loop);
+    }
   }
 #endif
 
-  GameCleanup();
+  GameCleanup(&loop.game);
   CloseWindow();
   CloseAudioDevice();
 
   return 0;
 }
 
-static void UpdateDrawFrame(void) {
-  GameUpdate();
-  GameDraw();
+static void UpdateDrawFrame(void *arg) {
+  MainLoop *loop = arg;
+  loop->accumulator += GetFrameTime();
+  int ticks = 0;
+  while (loop->accumulator >= 1.0 / SIM_FRAME_RATE && ticks < MAX_TICKS_PER_FRAME) {
+    loop->accumulator -= 1.0 / SIM_FRAME_RATE;
+    ticks++;
+  }
+  if (ticks == MAX_TICKS_PER_FRAME) {
+    loop->accumulator = 0.0;
+  }
+
+  GameUpdate(&loop->game, GameReadKeyboard(), ticks);
+  GameDraw(&loop->game);
   DrawFPS(5, 5);
 }
+
+// A whole decimal number from min to max, atoi would take "x" as 0 and "5x" as 5
+static bool ParseNumber(const char *text, long min, long max, long *value) {
+  char *end;
+  errno = 0;
+  *value = strtol(text, &end, 10);
+  return end != text && *end == '\0' && errno == 0 && *value >= min && *value <= max;
+}
+
+#if !defined(PLATFORM_WEB)
+// Soak test: the bot presses keys through the normal input path, every loop is one simulation tick with no frame cap,
+// and only every renderEvery-th tick is drawn, with GameDraw timed
+static void AutoplayRun(MainLoop *loop, Autoplay *autoplay) {
+  GameState *game = &loop->game;
+  SetMasterVolume(0.0f);
+  // the entry delay goes by in microseconds here, a deadline from it would cut every search short
+  AgentSetThinkingAhead(game->agent, false);
+  const double start = GetTime();
+  double lastReport = start;
+  while (!WindowShouldClose() && (autoplay->frameLimit == 0 || autoplay->frames < autoplay->frameLimit)) {
+    // ticks come far faster than real frames here, so the game holds still while the bot thinks instead of playing the piece blind
+    if (game->screenState == SCREEN_PLAY && AgentPoll(game->agent)) {
+      PollInputEvents();
+      continue;
+    }
+    const uint16_t keys = AutoplayGetKeys(game, autoplay->keys);
+    GameUpdate(game, GameGetInputFrame(keys, autoplay->keys), 1);
+    autoplay->keys = keys;
+    autoplay->frames++;
+    autoplay->games += (game->sim.events & SIM_EVENT_GAMEOVER) != 0;
+
+    if (autoplay->frames % autoplay->renderEvery != 0) {
+      // EndDrawing polls input, skipped frames still need it for the window to respond
+      PollInputEvents();
+      continue;
+    }
+    const double drawStart = GetTime();
+    GameDraw(game);
+    DrawTimingsAdd(&autoplay->timings, GetTime() - drawStart);
+
+    if (GetTime() - lastReport >= DRAW_TIMING_REPORT_SECONDS) {
+      lastReport = GetTime();
+      DrawTimingsReport(&autoplay->timings, autoplay, AgentGetStats(game->agent), lastReport - start);
+    }
+  }
+  DrawTimingsReport(&autoplay->timings, autoplay, AgentGetStats(game->agent), GetTime() - start);
+}
+
+// Plays a recorded game with the viewer's controls instead of the game's, nothing is recorded or played by the bot
+static void ViewerRun(GameState *game, const char *path) {
+  static Viewer viewer;
+  if (!ViewerOpen(&viewer, path, game)) {
+    return;
+  }
+  SetTargetFPS(120);
+  while (!WindowShouldClose()) {
+    ViewerUpdate(&viewer, game);
+    BeginDrawing();
+    ClearBackground(BLACK);
+    GameDrawScreen(game);
+    ViewerDraw(&viewer);
+    EndDrawing();
+  }
+  ViewerClose(&viewer);
+}
+
+// The bot's buttons while playing, and a fresh press of restart at game over
+static uint16_t AutoplayGetKeys(const GameState *game, uint16_t previousKeys) {
+  if (game->screenState == SCREEN_GAMEOVER) {
+    return previousKeys & (1 << GAME_KEY_RESTART) ? 0 : 1 << GAME_KEY_RESTART;
+  }
+  if (game->screenState != SCREEN_PLAY) {
+    return 0;
+  }
+  return AgentGetInput(game->agent, &game->sim);
+}
+
+static void DrawTimingsAdd(DrawTimings *timings, double seconds) {
+  const int bucket = (int)(seconds * 1e6 / DRAW_TIMING_BUCKET_US);
+  timings->buckets[bucket < DRAW_TIMING_BUCKETS ? bucket : DRAW_TIMING_BUCKETS - 1]++;
+  timings->count++;
+  timings->totalSeconds += seconds;
+  timings->maxSeconds = seconds > timings->maxSeconds ? seconds : timings->maxSeconds;
+}
+
+static void DrawTimingsReport(const DrawTimings *timings, const Autoplay *autoplay, const AgentStats *stats, double elapsed) {
+  if (timings->count == 0) {
+    return;
+  }
+  // upper edge of the bucket holding each percentile
+  const double percentiles[3] = {0.5, 0.99, 0.999};
+  double percentileMs[3] = {0};
+  for (int p = 0; p < 3; p++) {
+    long seen = 0;
+    for (int bucket = 0; bucket < DRAW_TIMING_BUCKETS; bucket++) {
+      seen += timings->buckets[bucket];
+      if (seen >= percentiles[p] * timings->count) {
+        percentileMs[p] = (bucket + 1) * DRAW_TIMING_BUCKET_US / 1000.0;
+        break;
+      }
+    }
+  }
+  printf("autoplay: %ld frames (%.1fx real time), %ld games, GameDraw avg %.3f ms, p50 %.2f ms, p99 %.2f ms, p99.9 %.2f ms, max %.3f ms\n",
+         autoplay->frames, autoplay->frames / SIM_FRAME_RATE / elapsed, autoplay->games, timings->totalSeconds * 1e3 / timings->count,
+         percentileMs[0], percentileMs[1], percentileMs[2], timings->maxSeconds * 1e3);
+  printf("autoplay: %ld bot plans, %ld late, %ld frames waited on them, %.0f nodes per plan\n", stats->plans, stats->latePlans,
+         stats->lateFrames, stats->plans > 0 ? (double)stats->nodes / stats->plans : 0.0);
+  fflush(stdout);
+}
+#endif
@@ -5,57 +5,8 @@
 
 #include "piece.h"
 
-const PieceType tetrominoes[] = {
-    // I
-    {{{{{0, 2}, {1, 2}, {2, 2}, {3, 2}}},
-      {{{2, 0}, {2, 1}, {2, 2}, {2, 3}}},
-      {{{0, 2}, {1, 2}, {2, 2}, {3, 2}}},
-      {{{2, 0}, {2, 1}, {2, 2}, {2, 3}}}},
-     {0.5, -0.5},
-     0},
-    // J
-    {{{{{1, 2}, {2, 2}, {3, 2}, {3, 3}}},
-      {{{1, 3}, {2, 1}, {2, 2}, {2, 3}}},
-      {{{1, 2}, {2, 2}, {3, 2}, {1, 1}}},
-      {{{3, 1}, {2, 1}, {2, 2}, {2, 3}}}},
-     {0, -1},
-     2},
-    // L
-    {{{{{1, 2}, {2, 2}, {3, 2}, {1, 3}}},
-      {{{1, 1}, {2, 1}, {2, 2}, {2, 3}}},
-      {{{1, 2}, {2, 2}, {3, 2}, {3, 1}}},
-      {{{3, 3}, {2, 1}, {2, 2}, {2, 3}}}},
-     {0, -1},
-     1},
-    // O
-    {{{{{1, 2}, {1, 3}, {2, 2}, {2, 3}}},
-      {{{1, 2}, {1, 3}, {2, 2}, {2, 3}}},
-      {{{1, 2}, {1, 3}, {2, 2}, {2, 3}}},
-      {{{1, 2}, {1, 3}, {2, 2}, {2, 3}}}},
-     {0.5, -1},
-     0},
-    // T
-    {{{{{1, 2}, {2, 2}, {3, 2}, {2, 3}}},
-      {{{2, 1}, {2, 2}, {2, 3}, {1, 2}}},
-      {{{1, 2}, {2, 2}, {3, 2}, {2, 1}}},
-      {{{2, 1}, {2, 2}, {2, 3}, {3, 2}}}},
-     {0, -1},
-     0},
-    // S
-    {{{{{2, 2}, {2, 3}, {3, 2}, {1, 3}}},
-      {{{2, 2}, {2, 1}, {3, 2}, {3, 3}}},
-      {{{2, 2}, {2, 3}, {3, 2}, {1, 3}}},
-      {{{2, 2}, {2, 1}, {3, 2}, {3, 3}}}},
-     {0, -1},
-     2},
-    // Z
-    {{{{{2, 2}, {2, 3}, {3, 3}, {1, 2}}},
-      {{{2, 3}, {2, 2}, {3, 1}, {3, 2}}},
-      {{{2, 2}, {2, 3}, {3, 3}, {1, 2}}},
-      {{{2, 3}, {2, 2}, {3, 1}, {3, 2}}}},
-     {0, -1},
-     1},
-};
+// the offset required so that each piece is centered when displayed on the "next piece" rectangle
+static const Vector2 displayOffsets[PIECE_COUNT] = {{0.5, -0.5}, {0, -1}, {0, -1}, {0.5, -1}, {0, -1}, {0, -1}, {0, -1}};
 
 static const Color colorPalettes[10][2] = {{{0, 88, 248, 255}, {60, 188, 252, 255}},   {{0, 168, 0, 255}, {184, 248, 24, 255}},
                                            {{216, 0, 204, 255}, {248, 120, 248, 255}}, {{0, 88, 248, 255}, {88, 216, 84, 255}},
@@ -97,80 +48,15 @@ void PieceDrawBlock(Vector2 position, int paletteIndex, int shapeType, float sca
 }
 
 void PieceDraw(const Piece *piece, const Vector2 screenPosition, int paletteIndex, float scale) {
+  const PieceConfiguration *blocks = &tetrominoes[piece->type].rotations[piece->rotationIndex];
   for (int i = 0; i < 4; i++) {
-    const PieceConfiguration *blocks = &piece->tetromino->rotations[piece->rotationIndex];
-    const Vector2 blockPosition = Vector2Add(blocks->points[i], piece->position);
+    const Vector2 blockPosition = {piece->x + blocks->cells[i].x, piece->y + blocks->cells[i].y};
     const Vector2 blockPositionOnScreen = Vector2Add(Vector2Scale(blockPosition, BLOCK_LEN * scale), screenPosition);
-    PieceDrawBlock(blockPositionOnScreen, paletteIndex, piece->tetromino->shapeType, scale);
+    PieceDrawBlock(blockPositionOnScreen, paletteIndex, tetrominoes[piece->type].shapeType, scale);
   }
 }
 
-void PieceRotateClockwise(Piece *piece, const Block board[ROWS][COLUMNS]) {
-  for (int i = 0; i < 4; i++) {
-    const PieceConfiguration *blocks = &piece->tetromino->rotations[(piece->rotationIndex + 1) % 4];
-    const Vector2 blockPosition = Vector2Add(blocks->points[i], piece->position);
-    if (blockPosition.x < 0 || blockPosition.x >= COLUMNS || blockPosition.y >= ROWS ||
-        board[(int)blockPosition.y][(int)blockPosition.x].occupied) {
-      return;
-    }
-  }
-
-  piece->rotationIndex = (piece->rotationIndex + 1) % 4;
-}
-
-void PieceRotateCounterClockwise(Piece *piece, const Block board[ROWS][COLUMNS]) {
-  for (int i = 0; i < 4; i++) {
-    const PieceConfiguration *blocks = &piece->tetromino->rotations[((piece->rotationIndex - 1) + 4) % 4];
-    const Vector2 blockPosition = Vector2Add(blocks->points[i], piece->position);
-    if (blockPosition.x < 0 || blockPosition.x >= COLUMNS || blockPosition.y >= ROWS ||
-        board[(int)blockPosition.y][(int)blockPosition.x].occupied) {
-      return;
-    }
-  }
-  piece->rotationIndex = ((piece->rotationIndex - 1) + 4) % 4;
-}
-
-void PieceMoveLeft(Piece *piece, const Block board[ROWS][COLUMNS]) {
-  for (int i = 0; i < 4; i++) {
-    const PieceConfiguration *blocks = &piece->tetromino->rotations[piece->rotationIndex];
-    Vector2 blockPosition = Vector2Add(blocks->points[i], piece->position);
-    blockPosition.x -= 1;
-    if (blockPosition.x < 0 || board[(int)blockPosition.y][(int)blockPosition.x].occupied) {
-      return;
-    }
-  }
-  piece->position.x -= 1;
-}
-
-void PieceMoveRight(Piece *piece, const Block board[ROWS][COLUMNS]) {
-  for (int i = 0; i < 4; i++) {
-    const PieceConfiguration *blocks = &piece->tetromino->rotations[piece->rotationIndex];
-    Vector2 blockPosition = Vector2Add(blocks->points[i], piece->position);
-    blockPosition.x += 1;
-    if (blockPosition.x >= COLUMNS || board[(int)blockPosition.y][(int)blockPosition.x].occupied) {
-      return;
-    }
-  }
-  piece->position.x += 1;
-}
-
-bool PieceMoveDown(Piece *piece, const Block board[ROWS][COLUMNS]) {
-  for (int i = 0; i < 4; i++) {
-    const PieceConfiguration *blocks = &piece->tetromino->rotations[piece->rotationIndex];
-    Vector2 blockPosition = Vector2Add(blocks->points[i], piece->position);
-    blockPosition.y += 1;
-    if (blockPosition.y >= ROWS || board[(int)blockPosition.y][(int)blockPosition.x].occupied) {
-      return false;
-    }
-  }
-  piece->position.y += 1;
-  return true;
-}
-
-Piece PieceGetRandom(const PieceType *previousPieceType) {
-  int randomIndex = GetRandomValue(0, 6);
-  if (&tetrominoes[randomIndex] == previousPieceType) {
-    randomIndex = GetRandomValue(0, 6);
-  }
-  return (Piece){&tetrominoes[randomIndex], tetrominoes[randomIndex].displayOffset, INITIAL_ROTATION};
+void PieceDrawPreview(int type, const Vector2 screenPosition, int paletteIndex, float scale) {
+  const Piece piece = {type, 0, 0, INITIAL_ROTATION};
+  PieceDraw(&piece, Vector2Add(screenPosition, Vector2Scale(displayOffsets[type], BLOCK_LEN * scale)), paletteIndex, scale);
 }
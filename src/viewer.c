@@ -0,0 +1,110 @@
+#include <raylib.h>
+
+#include "viewer.h"
+
+static void ViewerSeek(Viewer *viewer, GameState *game, long frame);
+static Rectangle ViewerGetProgressBar(void);
+
+// The game is drawn from the replay's first frame, paused so the controls can be found before anything happens
+bool ViewerOpen(Viewer *viewer, const char *path, GameState *game) {
+  *viewer = (Viewer){.speed = 1.0, .isPaused = true};
+  viewer->file = fopen(path, "rb");
+  viewer->reader = viewer->file ? ReplayReaderCreate(viewer->file) : NULL;
+  if (!viewer->reader) {
+    fprintf(stderr, "couldn't read a replay from %s\n", path);
+    ViewerClose(viewer);
+    return false;
+  }
+  ReplayStart(ReplayReaderGetHeader(viewer->reader), &game->sim);
+  game->screenState = SCREEN_PLAY;
+  return true;
+}
+
+void ViewerClose(Viewer *viewer) {
+  if (viewer->reader) {
+    ReplayReaderDestroy(viewer->reader);
+  }
+  if (viewer->file) {
+    fclose(viewer->file);
+  }
+  viewer->reader = NULL;
+  viewer->file = NULL;
+}
+
+// Handles the controls, then plays as many frames as the speed and the real time since the last update call for
+void ViewerUpdate(Viewer *viewer, GameState *game) {
+  const long frame = ReplayReaderGetFrame(viewer->reader);
+  const long jump = (long)(VIEWER_JUMP_SECONDS * SIM_FRAME_RATE);
+  if (IsKeyPressed(KEY_SPACE)) {
+    viewer->isPaused = !viewer->isPaused;
+    viewer->accumulator = 0.0;
+  }
+  if (IsKeyPressed(KEY_UP) && viewer->speed < VIEWER_MAX_SPEED) {
+    viewer->speed *= 2.0;
+  }
+  if (IsKeyPressed(KEY_DOWN) && viewer->speed > VIEWER_MIN_SPEED) {
+    viewer->speed /= 2.0;
+  }
+  if (IsKeyPressed(KEY_RIGHT) || IsKeyPressedRepeat(KEY_RIGHT)) {
+    viewer->isPaused = true;
+    ViewerSeek(viewer, game, frame + 1);
+  }
+  if (IsKeyPressed(KEY_LEFT) || IsKeyPressedRepeat(KEY_LEFT)) {
+    viewer->isPaused = true;
+    ViewerSeek(viewer, game, frame - 1);
+  }
+  if (IsKeyPressed(KEY_PAGE_UP)) {
+    ViewerSeek(viewer, game, frame + jump);
+  }
+  if (IsKeyPressed(KEY_PAGE_DOWN)) {
+    ViewerSeek(viewer, game, frame - jump);
+  }
+  const Rectangle bar = ViewerGetProgressBar();
+  if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) && CheckCollisionPointRec(GetMousePosition(), bar)) {
+    ViewerSeek(viewer, game, (long)((GetMouseX() - bar.x) / bar.width * ReplayReaderGetHeader(viewer->reader)->frameCount));
+  }
+
+  if (viewer->isPaused) {
+    return;
+  }
+  // a stalled frame shouldn't turn into a burst of catching up
+  const double limit = MAX_TICKS_PER_FRAME * viewer->speed;
+  viewer->accumulator += GetFrameTime() * SIM_FRAME_RATE * viewer->speed;
+  viewer->accumulator = viewer->accumulator > limit ? limit : viewer->accumulator;
+  uint8_t input;
+  for (; viewer->accumulator >= 1.0; viewer->accumulator -= 1.0) {
+    if (!ReplayReaderNext(viewer->reader, &input)) {
+      viewer->isPaused = true;
+      viewer->accumulator = 0.0;
+      break;
+    }
+    SimStep(&game->sim, input);
+  }
+}
+
+// The progress bar and playback state, drawn over the game screen
+void ViewerDraw(const Viewer *viewer) {
+  const ReplayHeader *header = ReplayReaderGetHeader(viewer->reader);
+  const uint32_t frame = ReplayReaderGetFrame(viewer->reader);
+  const Rectangle bar = ViewerGetProgressBar();
+  DrawRectangleRec((Rectangle){bar.x, bar.y, header->frameCount > 0 ? bar.width * frame / header->frameCount : 0, bar.height}, GRAY);
+  DrawRectangleLinesEx(bar, LINE_THICKNESS, WHITE);
+  const char *status = TextFormat("%s %gx  %.1f / %.1f s  frame %u / %u", viewer->isPaused ? "PAUSED" : "PLAYING", viewer->speed,
+                                  frame / SIM_FRAME_RATE, header->frameCount / SIM_FRAME_RATE, frame, header->frameCount);
+  DrawText(status, bar.x, bar.y - FONT_SIZE_SMALL - 5.0f, FONT_SIZE_SMALL, WHITE);
+}
+
+// Seeking past either end stops there
+static void ViewerSeek(Viewer *viewer, GameState *game, long frame) {
+  const long frameCount = ReplayReaderGetHeader(viewer->reader)->frameCount;
+  frame = frame < 0 ? 0 : frame > frameCount ? frameCount : frame;
+  if (!ReplayReaderSeek(viewer->reader, frame, &game->sim)) {
+    fprintf(stderr, "couldn't seek to frame %ld of the replay\n", frame);
+    viewer->isPaused = true;
+  }
+  viewer->accumulator = 0.0;
+}
+
+static Rectangle ViewerGetProgressBar(void) {
+  return (Rectangle){BLOCK_LEN, HEIGHT - BLOCK_LEN * 0.75f, WIDTH - 2 * BLOCK_LEN, BLOCK_LEN / 2.0f};
+}
@@ -0,0 +1,31 @@
+#ifndef VIEWER_H
+#define VIEWER_H
+
+#include <stdio.h>
+
+#include "core/replay.h"
+#include "game.h"
+
+#define VIEWER_MIN_SPEED 0.25
+#define VIEWER_MAX_SPEED 16.0
+// how far PageUp and PageDown jump
+#define VIEWER_JUMP_SECONDS 10
+
+// Plays a replay into GameState.sim for GameDrawScreen to draw, with the controls drawn below it.
+// Space pauses, Up and Down double or halve the speed, Left and Right step a frame, PageUp and PageDown jump 10 seconds,
+// and clicking the progress bar seeks there. Seeking restores the nearest keyframe, so it costs the same anywhere in the game.
+typedef struct {
+  FILE *file;
+  ReplayReader *reader;
+  double speed;
+  bool isPaused;
+  // frames not yet played at the current speed
+  double accumulator;
+} Viewer;
+
+bool ViewerOpen(Viewer *viewer, const char *path, GameState *game);
+void ViewerClose(Viewer *viewer);
+void ViewerUpdate(Viewer *viewer, GameState *game);
+void ViewerDraw(const Viewer *viewer);
+
+#endif // VIEWER_H
@@ -0,0 +1,169 @@
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/archive.h"
+#include "core/replay.h"
+
+static int ArchiveToolCreate(int argc, char **argv);
+static int ArchiveToolAdd(int argc, char **argv);
+static int ArchiveToolList(int argc, char **argv);
+static int ArchiveToolExtract(char **argv);
+static void *ArchiveToolReadFile(const char *path, uint32_t *length);
+static bool ArchiveToolParseNumber(const char *text, uint64_t max, uint64_t *value);
+
+static const char *usage = "usage: %s create ARCHIVE [--capacity N]\n"
+                           "       %s add ARCHIVE [--player N] REPLAY...\n"
+                           "       %s list ARCHIVE [--player N]\n"
+                           "       %s extract ARCHIVE INDEX OUTPUT\n";
+
+// Each command returns the exit code, or -1 for arguments it can't take
+int main(int argc, char **argv) {
+  int result = -1;
+  if (argc >= 3 && strcmp(argv[1], "create") == 0) {
+    result = ArchiveToolCreate(argc - 2, argv + 2);
+  } else if (argc >= 3 && strcmp(argv[1], "add") == 0) {
+    result = ArchiveToolAdd(argc - 2, argv + 2);
+  } else if (argc >= 3 && strcmp(argv[1], "list") == 0) {
+    result = ArchiveToolList(argc - 2, argv + 2);
+  } else if (argc == 5 && strcmp(argv[1], "extract") == 0) {
+    result = ArchiveToolExtract(argv + 2);
+  }
+  if (result < 0) {
+    fprintf(stderr, usage, argv[0], argv[0], argv[0], argv[0]);
+    return 1;
+  }
+  return result;
+}
+
+static int ArchiveToolCreate(int argc, char **argv) {
+  uint64_t capacity = ARCHIVE_DEFAULT_CAPACITY;
+  const bool hasCapacity = argc == 3 && strcmp(argv[1], "--capacity") == 0;
+  if ((argc != 1 && !hasCapacity) || (hasCapacity && (!ArchiveToolParseNumber(argv[2], UINT32_MAX, &capacity) || capacity == 0))) {
+    return -1;
+  }
+  Archive *archive = ArchiveCreate(argv[0], capacity);
+  if (!archive) {
+    fprintf(stderr, "couldn't create %s: %s\n", argv[0], strerror(errno));
+    return 1;
+  }
+  ArchiveClose(archive);
+  return 0;
+}
+
+static int ArchiveToolAdd(int argc, char **argv) {
+  uint64_t player = 0;
+  int first = 1;
+  if (argc >= 2 && strcmp(argv[1], "--player") == 0) {
+    if (argc < 3 || !ArchiveToolParseNumber(argv[2], UINT64_MAX, &player)) {
+      return -1;
+    }
+    first = 3;
+  }
+  Archive *archive = ArchiveOpen(argv[0], true);
+  if (!archive) {
+    fprintf(stderr, "couldn't open %s for appending: %s\n", argv[0], strerror(errno));
+    return 1;
+  }
+  int failed = 0;
+  for (int i = first; i < argc; i++) {
+    uint32_t length;
+    void *replay = ArchiveToolReadFile(argv[i], &length);
+    if (!replay || !ArchiveAppend(archive, player, replay, length)) {
+      fprintf(stderr, "couldn't add %s: %s\n", argv[i], strerror(errno));
+      failed++;
+    }
+    free(replay);
+  }
+  ArchiveClose(archive);
+  return failed > 0;
+}
+
+// A plain scan of the mapped index, filtered by player if one is given
+static int ArchiveToolList(int argc, char **argv) {
+  const bool isFiltered = argc == 3 && strcmp(argv[1], "--player") == 0;
+  uint64_t player = 0;
+  if ((argc != 1 && !isFiltered) || (isFiltered && !ArchiveToolParseNumber(argv[2], UINT64_MAX, &player))) {
+    return -1;
+  }
+  Archive *archive = ArchiveOpen(argv[0], false);
+  if (!archive) {
+    fprintf(stderr, "couldn't open %s: %s\n", argv[0], strerror(errno));
+    return 1;
+  }
+  const ArchiveEntry *entries = ArchiveGetEntries(archive);
+  const uint32_t count = ArchiveGetCount(archive);
+  printf("%8s %20s %16s %9s %5s %5s %5s %8s %6s\n", "index", "player", "seed", "score", "lines", "start", "level", "frames", "bytes");
+  for (uint32_t i = 0; i < count; i++) {
+    const ArchiveEntry *entry = &entries[i];
+    if (isFiltered && entry->player != player) {
+      continue;
+    }
+    printf("%8u %20" PRIu64 " %016" PRIx64 " %9d %5u %5u %5u %8u %6u%s\n", i, entry->player, entry->seed, entry->score, entry->linesCleared,
+           entry->startingLevel, entry->level, entry->frameCount, entry->length, entry->flags & REPLAY_FLAG_GAME_OVER ? "" : " unfinished");
+  }
+  printf("%u of %u entries used\n", count, ArchiveGetCapacity(archive));
+  ArchiveClose(archive);
+  return 0;
+}
+
+// Writes one entry back out as a replay file
+static int ArchiveToolExtract(char **argv) {
+  uint64_t index;
+  if (!ArchiveToolParseNumber(argv[1], UINT32_MAX, &index)) {
+    return -1;
+  }
+  Archive *archive = ArchiveOpen(argv[0], false);
+  if (!archive) {
+    fprintf(stderr, "couldn't open %s: %s\n", argv[0], strerror(errno));
+    return 1;
+  }
+  if (index >= ArchiveGetCount(archive)) {
+    fprintf(stderr, "%s has no entry %" PRIu64 "\n", argv[0], index);
+    ArchiveClose(archive);
+    return 1;
+  }
+  const ArchiveEntry *entry = &ArchiveGetEntries(archive)[index];
+  void *replay = malloc(entry->length);
+  FILE *file = replay && ArchiveRead(archive, entry, replay) ? fopen(argv[2], "wb") : NULL;
+  bool isExtracted = file && fwrite(replay, entry->length, 1, file) == 1;
+  if (file) {
+    isExtracted &= fclose(file) == 0;
+  }
+  if (!isExtracted) {
+    fprintf(stderr, "couldn't extract entry %" PRIu64 " to %s\n", index, argv[2]);
+  }
+  free(replay);
+  ArchiveClose(archive);
+  return !isExtracted;
+}
+
+static void *ArchiveToolReadFile(const char *path, uint32_t *length) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    return NULL;
+  }
+  void *data = NULL;
+  long size = 0;
+  if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) > 0 && fseek(file, 0, SEEK_SET) == 0) {
+    data = malloc(size);
+    if (data && fread(data, size, 1, file) != 1) {
+      free(data);
+      data = NULL;
+    }
+  }
+  errno = size == 0 ? EINVAL : errno;
+  fclose(file);
+  *length = size;
+  return data;
+}
+
+// A whole decimal number no bigger than max, strtoull alone takes "abc" as 0 and "-1" as its largest value
+static bool ArchiveToolParseNumber(const char *text, uint64_t max, uint64_t *value) {
+  char *end;
+  errno = 0;
+  *value = strtoull(text, &end, 10);
+  return text[0] >= '0' && text[0] <= '9' && *end == '\0' && errno == 0 && *value <= max;
+}
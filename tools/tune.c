@@ -0,0 +1,305 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bot/bot.h"
+
+#define TUNE_LEVELS 20
+#define TUNE_GENES 9
+#define TUNE_ELITES 2
+#define TUNE_TOURNAMENT 3
+#define TUNE_MUTATION_RATE 0.2f
+#define TUNE_CHECKPOINT_VERSION 1
+
+// EvalWeights is nothing but floats, each one is a gene
+typedef union {
+  EvalWeights weights;
+  float genes[TUNE_GENES];
+} Candidate;
+
+typedef struct {
+  int populationSize;
+  int generations;
+  int gamesPerLevel;
+  int pieceLimit;
+  int threads;
+  int beamWidth;
+  uint64_t seed;
+  const char *checkpointPath;
+} TuneConfig;
+
+typedef struct {
+  TuneConfig config;
+  Pool *pool;
+  Bot **bots;
+  Candidate *population;
+  long *fitness;
+  // the same seeds every generation, so fitness differences come from the weights and not the pieces
+  uint64_t *gameSeeds;
+  int gamesPerCandidate;
+  int generation;
+  Rng rng;
+  long pieces;
+} Tuner;
+
+static void TunePlayGame(void *context, int index, int worker);
+static void TuneEvolve(Tuner *tuner);
+static int TuneTournament(Tuner *tuner);
+static float TuneGaussian(Rng *rng);
+static bool TuneLoadCheckpoint(Tuner *tuner);
+static void TuneSaveCheckpoint(const Tuner *tuner, int generation);
+static double NowSeconds(void);
+
+int main(int argc, char **argv) {
+  TuneConfig config = {
+      .populationSize = 64,
+      .generations = 50,
+      .gamesPerLevel = 1,
+      .pieceLimit = 1000,
+      .threads = 0,
+      .beamWidth = 8,
+      .seed = 1,
+      .checkpointPath = "tune.checkpoint",
+  };
+  for (int i = 1; i < argc; i++) {
+    const bool hasValue = i + 1 < argc;
+    if (hasValue && strcmp(argv[i], "--population") == 0) {
+      config.populationSize = atoi(argv[++i]);
+    } else if (hasValue && strcmp(argv[i], "--generations") == 0) {
+      config.generations = atoi(argv[++i]);
+    } else if (hasValue && strcmp(argv[i], "--games-per-level") == 0) {
+      config.gamesPerLevel = atoi(argv[++i]);
+    } else if (hasValue && strcmp(argv[i], "--piece-limit") == 0) {
+      config.pieceLimit = atoi(argv[++i]);
+    } else if (hasValue && strcmp(argv[i], "--threads") == 0) {
+      config.threads = atoi(argv[++i]);
+    } else if (hasValue && strcmp(argv[i], "--beam") == 0) {
+      config.beamWidth = atoi(argv[++i]);
+    } else if (hasValue && strcmp(argv[i], "--seed") == 0) {
+      config.seed = strtoull(argv[++i], NULL, 10);
+    } else if (hasValue && strcmp(argv[i], "--checkpoint") == 0) {
+      config.checkpointPath = argv[++i];
+    } else {
+      fprintf(stderr,
+              "usage: %s [--population N] [--generations N] [--games-per-level N] [--piece-limit N] [--threads N] [--beam N] [--seed N]"
+              " [--checkpoint PATH]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+  if (config.populationSize <= TUNE_ELITES || config.gamesPerLevel < 1 || config.pieceLimit < 1) {
+    fprintf(stderr, "population must be over %d, games per level and piece limit at least 1\n", TUNE_ELITES);
+    return 1;
+  }
+
+  static Tuner tuner;
+  tuner.config = config;
+  tuner.gamesPerCandidate = TUNE_LEVELS * config.gamesPerLevel;
+  tuner.population = malloc(config.populationSize * sizeof(Candidate));
+  tuner.fitness = malloc(config.populationSize * sizeof(long));
+  tuner.gameSeeds = malloc(tuner.gamesPerCandidate * sizeof(uint64_t));
+  RngSeed(&tuner.rng, config.seed);
+  for (int i = 0; i < tuner.gamesPerCandidate; i++) {
+    tuner.gameSeeds[i] = (uint64_t)RngNext(&tuner.rng) << 32 | RngNext(&tuner.rng);
+  }
+
+  if (TuneLoadCheckpoint(&tuner)) {
+    printf("resuming %s at generation %d\n", config.checkpointPath, tuner.generation);
+  } else {
+    // the defaults, and mutations of them for the rest
+    for (int i = 0; i < config.populationSize; i++) {
+      tuner.population[i].weights = evalDefaultWeights;
+      for (int gene = 0; i > 0 && gene < TUNE_GENES; gene++) {
+        tuner.population[i].genes[gene] += TuneGaussian(&tuner.rng) * (0.25f * fabsf(tuner.population[i].genes[gene]) + 0.05f);
+      }
+    }
+  }
+
+  tuner.pool = PoolCreate(config.threads > 0 ? config.threads : (int)sysconf(_SC_NPROCESSORS_ONLN));
+  const int threadCount = PoolThreadCount(tuner.pool);
+  tuner.bots = malloc(threadCount * sizeof(Bot *));
+  for (int i = 0; i < threadCount; i++) {
+    // games run in parallel, each bot searches on its own thread
+    BotConfig botConfig = botDefaultConfig;
+    botConfig.threadCount = 1;
+    botConfig.maxBeamWidth = config.beamWidth;
+    // the table is cleared for every game since each candidate has its own weights, so it wouldn't pay for its memory per thread
+    botConfig.transpositionBytes = 0;
+    tuner.bots[i] = BotCreate(&botConfig);
+    if (!tuner.bots[i]) {
+      fprintf(stderr, "couldn't create a bot\n");
+      return 1;
+    }
+  }
+  printf("tuning %d candidates x %d games (levels 0-%d), up to %d pieces each, %d threads\n", config.populationSize,
+         tuner.gamesPerCandidate, TUNE_LEVELS - 1, config.pieceLimit, threadCount);
+
+  for (; tuner.generation < config.generations; tuner.generation++) {
+    memset(tuner.fitness, 0, config.populationSize * sizeof(long));
+    tuner.pieces = 0;
+    const double start = NowSeconds();
+    PoolRun(tuner.pool, config.populationSize * tuner.gamesPerCandidate, TunePlayGame, &tuner);
+    const double elapsed = NowSeconds() - start;
+
+    int best = 0;
+    double meanFitness = 0.0;
+    for (int i = 0; i < config.populationSize; i++) {
+      best = tuner.fitness[i] > tuner.fitness[best] ? i : best;
+      meanFitness += (double)tuner.fitness[i] / config.populationSize;
+    }
+    const EvalWeights *weights = &tuner.population[best].weights;
+    printf("generation %d: %.1f s, %.1f games/s, %.0f pieces/s, mean score %.0f, best %.0f per game\n", tuner.generation, elapsed,
+           config.populationSize * tuner.gamesPerCandidate / elapsed, tuner.pieces / elapsed, meanFitness / tuner.gamesPerCandidate,
+           (double)tuner.fitness[best] / tuner.gamesPerCandidate);
+    printf("  best: height %.3f holes %.3f bumpiness %.3f wells %.3f transitions %.3f lines %.3f %.3f %.3f %.3f\n",
+           weights->aggregateHeight, weights->holes, weights->bumpiness, weights->wells, weights->rowTransitions, weights->lineClears[0],
+           weights->lineClears[1], weights->lineClears[2], weights->lineClears[3]);
+    fflush(stdout);
+
+    TuneEvolve(&tuner);
+    TuneSaveCheckpoint(&tuner, tuner.generation + 1);
+  }
+
+  for (int i = 0; i < threadCount; i++) {
+    BotDestroy(tuner.bots[i]);
+  }
+  PoolDestroy(tuner.pool);
+  free(tuner.bots);
+  free(tuner.population);
+  free(tuner.fitness);
+  free(tuner.gameSeeds);
+  return 0;
+}
+
+// One task per (candidate, game), the fitness of a candidate is its total score over the seed set
+static void TunePlayGame(void *context, int index, int worker) {
+  Tuner *tuner = context;
+  const int candidate = index / tuner->gamesPerCandidate;
+  const int game = index % tuner->gamesPerCandidate;
+  Bot *bot = tuner->bots[worker];
+  BotSetWeights(bot, &tuner->population[candidate].weights);
+  BotReset(bot);
+
+  SimState state;
+  SimReset(&state, tuner->gameSeeds[game]);
+  SimStart(&state, game % TUNE_LEVELS);
+  int pieces = 0;
+  while (!state.isGameOver && pieces <= tuner->config.pieceLimit) {
+    SimStep(&state, BotGetInput(bot, &state));
+    pieces = 0;
+    for (int i = 0; i < PIECE_COUNT; i++) {
+      pieces += state.statistics[i];
+    }
+  }
+  __atomic_fetch_add(&tuner->fitness[candidate], state.score, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&tuner->pieces, pieces, __ATOMIC_RELAXED);
+}
+
+// Keeps the elites, fills the rest with tournament-picked parents, uniform crossover and gaussian mutation
+static void TuneEvolve(Tuner *tuner) {
+  const int size = tuner->config.populationSize;
+  Candidate *next = malloc(size * sizeof(Candidate));
+  int elites[TUNE_ELITES];
+  for (int i = 0; i < TUNE_ELITES; i++) {
+    int best = -1;
+    for (int j = 0; j < size; j++) {
+      bool isTaken = false;
+      for (int k = 0; k < i; k++) {
+        isTaken |= elites[k] == j;
+      }
+      if (!isTaken && (best < 0 || tuner->fitness[j] > tuner->fitness[best])) {
+        best = j;
+      }
+    }
+    elites[i] = best;
+    next[i] = tuner->population[best];
+  }
+
+  for (int i = TUNE_ELITES; i < size; i++) {
+    const Candidate *mother = &tuner->population[TuneTournament(tuner)];
+    const Candidate *father = &tuner->population[TuneTournament(tuner)];
+    for (int gene = 0; gene < TUNE_GENES; gene++) {
+      float value = RngNext(&tuner->rng) & 1 ? mother->genes[gene] : father->genes[gene];
+      if (RngNext(&tuner->rng) / 4294967296.0f < TUNE_MUTATION_RATE) {
+        value += TuneGaussian(&tuner->rng) * (0.1f * fabsf(value) + 0.02f);
+      }
+      next[i].genes[gene] = value;
+    }
+  }
+  memcpy(tuner->population, next, size * sizeof(Candidate));
+  free(next);
+}
+
+static int TuneTournament(Tuner *tuner) {
+  int best = RngRange(&tuner->rng, 0, tuner->config.populationSize - 1);
+  for (int i = 1; i < TUNE_TOURNAMENT; i++) {
+    const int challenger = RngRange(&tuner->rng, 0, tuner->config.populationSize - 1);
+    best = tuner->fitness[challenger] > tuner->fitness[best] ? challenger : best;
+  }
+  return best;
+}
+
+// Box-Muller, one of the pair is enough here
+static float TuneGaussian(Rng *rng) {
+  const double u = (RngNext(rng) + 1.0) / 4294967297.0;
+  const double v = RngNext(rng) / 4294967296.0;
+  return (float)(sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v));
+}
+
+// Text file: a header, the generation to evaluate next, the tuner's Rng and one line of genes per candidate
+static bool TuneLoadCheckpoint(Tuner *tuner) {
+  FILE *file = fopen(tuner->config.checkpointPath, "r");
+  if (!file) {
+    return false;
+  }
+  int version = 0;
+  int populationSize = 0;
+  unsigned long long rngState = 0;
+  bool isValid = fscanf(file, "tune-checkpoint %d\ngeneration %d\nrng %llu\npopulation %d\n", &version, &tuner->generation, &rngState,
+                        &populationSize) == 4 &&
+                 version == TUNE_CHECKPOINT_VERSION && populationSize == tuner->config.populationSize;
+  for (int i = 0; isValid && i < populationSize; i++) {
+    for (int gene = 0; isValid && gene < TUNE_GENES; gene++) {
+      isValid = fscanf(file, "%f", &tuner->population[i].genes[gene]) == 1;
+    }
+  }
+  fclose(file);
+  if (!isValid) {
+    fprintf(stderr, "ignoring %s, it's not a checkpoint for this population size\n", tuner->config.checkpointPath);
+    tuner->generation = 0;
+    return false;
+  }
+  tuner->rng.state = rngState;
+  return true;
+}
+
+// Written next to the checkpoint and renamed over it, so a crash mid-write keeps the previous one
+static void TuneSaveCheckpoint(const Tuner *tuner, int generation) {
+  char temporaryPath[4096];
+  snprintf(temporaryPath, sizeof(temporaryPath), "%s.tmp", tuner->config.checkpointPath);
+  FILE *file = fopen(temporaryPath, "w");
+  if (!file) {
+    fprintf(stderr, "couldn't write %s\n", temporaryPath);
+    return;
+  }
+  fprintf(file, "tune-checkpoint %d\ngeneration %d\nrng %llu\npopulation %d\n", TUNE_CHECKPOINT_VERSION, generation,
+          (unsigned long long)tuner->rng.state, tuner->config.populationSize);
+  for (int i = 0; i < tuner->config.populationSize; i++) {
+    for (int gene = 0; gene < TUNE_GENES; gene++) {
+      fprintf(file, gene == 0 ? "%.9g" : " %.9g", tuner->population[i].genes[gene]);
+    }
+    fprintf(file, "\n");
+  }
+  if (fclose(file) != 0 || rename(temporaryPath, tuner->config.checkpointPath) != 0) {
+    fprintf(stderr, "couldn't write %s\n", tuner->config.checkpointPath);
+  }
+}
+
+static double NowSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <time.h>
+
+#include "core/replay.h"
+
+typedef struct {
+  SimState state;
+  uint32_t frames;
+  // the game ended before the last recorded input
+  bool isOverEarly;
+} Replayed;
+
+static bool VerifyReplay(const char *path);
+static bool VerifyPlay(ReplayReader *reader, Replayed *replayed);
+static double NowSeconds(void);
+
+// Replays every file given through the game rules with no window, audio or frame cap and checks the results in its header.
+// Exits with 1 if any replay doesn't hold up, so it can gate a leaderboard submission.
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s REPLAY...\n", argv[0]);
+    return 1;
+  }
+  int failed = 0;
+  for (int i = 1; i < argc; i++) {
+    failed += !VerifyReplay(argv[i]);
+  }
+  if (argc > 2) {
+    printf("%d of %d replays verified\n", argc - 1 - failed, argc - 1);
+  }
+  return failed > 0;
+}
+
+static bool VerifyReplay(const char *path) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    fprintf(stderr, "%s: couldn't open\n", path);
+    return false;
+  }
+  ReplayReader *reader = ReplayReaderCreate(file);
+  if (!reader) {
+    fprintf(stderr, "%s: not a valid replay (supported versions 1-%d)\n", path, REPLAY_VERSION);
+    fclose(file);
+    return false;
+  }
+  const ReplayHeader *header = ReplayReaderGetHeader(reader);
+  // scores scale with the level, a start the level select can't reach would verify with inflated results
+  if (header->startingLevel > SIM_MAX_STARTING_LEVEL || (header->previousInput & ~REPLAY_INPUT_MASK) != 0) {
+    printf("%s: FAILED, the game can't start like this: starting level %u (at most %d), previous input 0x%02x\n", path,
+           header->startingLevel, SIM_MAX_STARTING_LEVEL, header->previousInput);
+    ReplayReaderDestroy(reader);
+    fclose(file);
+    return false;
+  }
+  static Replayed replayed;
+  const double start = NowSeconds();
+  const bool isComplete = VerifyPlay(reader, &replayed);
+  const double seconds = NowSeconds() - start;
+  const SimState *state = &replayed.state;
+
+  const char *problem = NULL;
+  if (!isComplete) {
+    problem = "the inputs end before the frame count";
+  } else if (replayed.isOverEarly) {
+    problem = "there are inputs after the game ended";
+  } else if (state->isGameOver != ((header->flags & REPLAY_FLAG_GAME_OVER) != 0)) {
+    problem = state->isGameOver ? "the game ends but isn't marked over" : "the game is marked over but doesn't end";
+  } else if (state->score != header->score || (uint32_t)state->linesCleared != header->linesCleared ||
+             state->currentLevel != header->level) {
+    problem = "the results don't match";
+  }
+  if (problem) {
+    printf("%s: FAILED, %s: replayed %u of %u frames to score %d, %d lines, level %d, the header says score %d, %u lines, level %u\n",
+           path, problem, replayed.frames, header->frameCount, state->score, state->linesCleared, state->currentLevel, header->score,
+           header->linesCleared, header->level);
+  } else {
+    printf("%s: ok, %u frames, score %d, %d lines, level %d, verified in %.3f ms\n", path, replayed.frames, state->score,
+           state->linesCleared, state->currentLevel, seconds * 1e3);
+  }
+  ReplayReaderDestroy(reader);
+  fclose(file);
+  return problem == NULL;
+}
+
+// False if the file ran out before the header's frame count
+static bool VerifyPlay(ReplayReader *reader, Replayed *replayed) {
+  const ReplayHeader *header = ReplayReaderGetHeader(reader);
+  SimState *state = &replayed->state;
+  ReplayStart(header, state);
+  replayed->isOverEarly = false;
+  uint8_t input;
+  while (ReplayReaderNext(reader, &input)) {
+    replayed->isOverEarly |= state->isGameOver;
+    SimStep(state, input);
+  }
+  replayed->frames = ReplayReaderGetFrame(reader);
+  return replayed->frames == header->frameCount;
+}
+
+static double NowSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}